@@ -0,0 +1,108 @@
+// access.cpp
+// Simulated memory access streams. Each instruction a process executes
+// touches a few of its pages, chosen by the configured access pattern over the
+// pages its memory_requirement spans. A process draws from its own stream,
+// seeded from its program seed, so runs replay from random-seed.
+#include "headers.h"
+#include <cmath>
+
+AccessPattern config_access_pattern = ACCESS_ZIPF;
+int config_pages_per_instruction = 1;
+
+const double ZIPF_EXPONENT = 0.99;  // the usual YCSB skew
+const int PHASE_LENGTH = 256;       // accesses before a phased working set moves
+const uint64_t ACCESS_SEED_STREAM = UINT64_MAX;  // program chunks take streams 0, 1, ...
+
+namespace {
+
+// Rejection-inversion sampling of a Zipf distribution over ranks 1..n
+// (Hormann & Derflinger): a few exp/log calls per sample and no table, so
+// every process can have its own n.
+double helper1(double x) { return abs(x) > 1e-8 ? log1p(x) / x : 1 - x / 2; }
+double helper2(double x) { return abs(x) > 1e-8 ? expm1(x) / x : 1 + x / 2; }
+double zipfH(double x) { return exp(-ZIPF_EXPONENT * log(x)); }
+double zipfHIntegral(double x) {
+    double log_x = log(x);
+    return helper2((1 - ZIPF_EXPONENT) * log_x) * log_x;
+}
+double zipfHIntegralInverse(double x) {
+    double t = max(-1.0, x * (1 - ZIPF_EXPONENT));
+    return exp(helper1(t) * x);
+}
+
+// Uniform in [0, 1)
+double uniform01(uint64_t& state) {
+    return (splitmix64(state) >> 11) * 0x1.0p-53;
+}
+
+uint32_t uniformBelow(uint64_t& state, uint32_t bound) {
+    return static_cast<uint32_t>((splitmix64(state) >> 32) * bound >> 32);
+}
+
+void startAccessStream(PCB* process) {
+    AccessState& access = process->access;
+    int bytes = process->memory_requirement > 0 ? process->memory_requirement : g_min_mem_per_proc;
+    access.pages = max(1, calculatePagesRequired(bytes));
+    access.rng_state = deriveSeed(process->program_seed, ACCESS_SEED_STREAM);
+    access.next_page = 0;
+    access.phase_base = 0;
+    access.phase_left = 0;
+    access.zipf_h_x1 = zipfHIntegral(1.5) - 1;
+    access.zipf_h_n = zipfHIntegral(access.pages + 0.5);
+    access.zipf_s = 2 - zipfHIntegralInverse(zipfHIntegral(2.5) - zipfH(2));
+    access.initialized = true;
+}
+
+// Rank 1 is the hottest page, so the symbol table at page 0 is the hottest
+int zipfPage(AccessState& access) {
+    while (true) {
+        double u = access.zipf_h_n + uniform01(access.rng_state) * (access.zipf_h_x1 - access.zipf_h_n);
+        double x = zipfHIntegralInverse(u);
+        int rank = static_cast<int>(x + 0.5);
+        rank = min(max(rank, 1), access.pages);
+        if (rank - x <= access.zipf_s || u >= zipfHIntegral(rank + 0.5) - zipfH(rank)) {
+            return rank - 1;
+        }
+    }
+}
+
+}  // namespace
+
+// Next page the process touches. Only the core running it calls this.
+int nextAccessPage(PCB* process) {
+    AccessState& access = process->access;
+    if (!access.initialized) startAccessStream(process);
+
+    switch (config_access_pattern) {
+        case ACCESS_SEQUENTIAL: {
+            int page = access.next_page;
+            access.next_page = (page + 1) % access.pages;
+            return page;
+        }
+        case ACCESS_UNIFORM:
+            return static_cast<int>(uniformBelow(access.rng_state, access.pages));
+        case ACCESS_PHASED: {
+            // Uniform over a window of about an eighth of the pages, which
+            // jumps somewhere else every PHASE_LENGTH accesses
+            int window = min(access.pages, max(2, access.pages / 8));
+            if (access.phase_left == 0) {
+                access.phase_base = static_cast<int>(uniformBelow(access.rng_state, access.pages));
+                access.phase_left = PHASE_LENGTH;
+            }
+            --access.phase_left;
+            return (access.phase_base + static_cast<int>(uniformBelow(access.rng_state, window))) % access.pages;
+        }
+        case ACCESS_ZIPF:
+        default:
+            return zipfPage(access);
+    }
+}
+
+const char* accessPatternName() {
+    switch (config_access_pattern) {
+        case ACCESS_SEQUENTIAL: return "sequential";
+        case ACCESS_UNIFORM: return "uniform";
+        case ACCESS_PHASED: return "phased";
+        default: return "zipf";
+    }
+}
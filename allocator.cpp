@@ -0,0 +1,398 @@
+// allocator.cpp
+// Allocators for the contiguous process memory space. memory.cpp owns the
+// active one and calls it under g_memory_mutex.
+#include "headers.h"
+#include <set>
+
+namespace {
+
+// Free extents keyed by start address, as a treap whose nodes also record the
+// largest extent in their subtree. That lets "lowest-addressed extent of at
+// least n bytes at or after some address" (first-fit, next-fit) descend
+// straight to the answer instead of scanning the holes in order.
+class ExtentTree {
+public:
+    void clear() {
+        nodes.clear();
+        unused_nodes.clear();
+        root = -1;
+    }
+
+    void insert(int start, int size) {
+        int node = newNode(start, size);
+        int left, right;
+        split(root, start, left, right);
+        root = merge(merge(left, node), right);
+    }
+
+    void erase(int start) {
+        int left, middle, right;
+        split(root, start, left, middle);
+        split(middle, start + 1, middle, right);
+        if (middle != -1) unused_nodes.push_back(middle);
+        root = merge(left, right);
+    }
+
+    // Last extent starting at or before address
+    bool floor(int address, MemoryExtent& extent) const {
+        int best = -1;
+        for (int t = root; t != -1;) {
+            if (nodes[t].start <= address) {
+                best = t;
+                t = nodes[t].right;
+            } else {
+                t = nodes[t].left;
+            }
+        }
+        if (best == -1) return false;
+        extent = {nodes[best].start, nodes[best].size};
+        return true;
+    }
+
+    // First extent starting at or after address
+    bool ceil(int address, MemoryExtent& extent) const {
+        int best = -1;
+        for (int t = root; t != -1;) {
+            if (nodes[t].start >= address) {
+                best = t;
+                t = nodes[t].left;
+            } else {
+                t = nodes[t].right;
+            }
+        }
+        if (best == -1) return false;
+        extent = {nodes[best].start, nodes[best].size};
+        return true;
+    }
+
+    // Lowest start >= from among extents of at least min_size bytes, or -1
+    int findFirst(int min_size, int from) const { return findFirst(root, min_size, from); }
+
+    void collect(vector<MemoryExtent>& out) const { collect(root, out); }
+
+private:
+    struct Node {
+        int start;
+        int size;
+        int max_size;  // largest extent in this subtree
+        uint32_t priority;
+        int left;
+        int right;
+    };
+
+    int newNode(int start, int size) {
+        uint32_t priority = static_cast<uint32_t>(splitmix64(priority_state));
+        Node node{start, size, size, priority, -1, -1};
+        if (!unused_nodes.empty()) {
+            int index = unused_nodes.back();
+            unused_nodes.pop_back();
+            nodes[index] = node;
+            return index;
+        }
+        nodes.push_back(node);
+        return static_cast<int>(nodes.size()) - 1;
+    }
+
+    void update(int t) {
+        Node& node = nodes[t];
+        node.max_size = node.size;
+        if (node.left != -1) node.max_size = max(node.max_size, nodes[node.left].max_size);
+        if (node.right != -1) node.max_size = max(node.max_size, nodes[node.right].max_size);
+    }
+
+    // left: starts < key, right: starts >= key
+    void split(int t, int key, int& left, int& right) {
+        if (t == -1) {
+            left = right = -1;
+        } else if (nodes[t].start < key) {
+            split(nodes[t].right, key, nodes[t].right, right);
+            left = t;
+            update(t);
+        } else {
+            split(nodes[t].left, key, left, nodes[t].left);
+            right = t;
+            update(t);
+        }
+    }
+
+    int merge(int left, int right) {
+        if (left == -1) return right;
+        if (right == -1) return left;
+        if (nodes[left].priority > nodes[right].priority) {
+            nodes[left].right = merge(nodes[left].right, right);
+            update(left);
+            return left;
+        }
+        nodes[right].left = merge(left, nodes[right].left);
+        update(right);
+        return right;
+    }
+
+    int findFirst(int t, int min_size, int from) const {
+        if (t == -1 || nodes[t].max_size < min_size) return -1;
+        const Node& node = nodes[t];
+        if (node.start < from) return findFirst(node.right, min_size, from);
+        int found = findFirst(node.left, min_size, from);
+        if (found != -1) return found;
+        if (node.size >= min_size) return node.start;
+        return findFirst(node.right, min_size, from);
+    }
+
+    void collect(int t, vector<MemoryExtent>& out) const {
+        if (t == -1) return;
+        collect(nodes[t].left, out);
+        out.push_back({nodes[t].start, nodes[t].size});
+        collect(nodes[t].right, out);
+    }
+
+    vector<Node> nodes;
+    vector<int> unused_nodes;
+    int root = -1;
+    uint64_t priority_state = 0x2545F4914F6CDD1DULL;
+};
+
+// Variable-size extents carved from free holes. Holes are indexed both by
+// address (placement and coalescing) and by (size, address) for best-fit.
+class ExtentAllocator : public MemoryAllocator {
+public:
+    explicit ExtentAllocator(MemoryAllocatorType p_type) : type(p_type) {}
+
+    const char* name() const override {
+        switch (type) {
+            case ALLOC_BEST_FIT: return "best-fit";
+            case ALLOC_NEXT_FIT: return "next-fit";
+            default: return "first-fit";
+        }
+    }
+
+    void reset(int total_bytes) override {
+        by_address.clear();
+        by_size.clear();
+        total = max(0, total_bytes);
+        free_bytes = 0;
+        rover = 0;
+        if (total_bytes > 0) addHole(0, total_bytes);
+    }
+
+    bool allocate(int size, MemoryExtent& block) override {
+        int start = -1;
+        if (type == ALLOC_BEST_FIT) {
+            auto hole = by_size.lower_bound({size, INT_MIN});
+            if (hole != by_size.end()) start = hole->second;
+        } else if (type == ALLOC_NEXT_FIT) {
+            start = by_address.findFirst(size, rover);
+            if (start == -1) start = by_address.findFirst(size, 0);
+        } else {
+            start = by_address.findFirst(size, 0);
+        }
+        if (start == -1) return false;
+
+        MemoryExtent hole{start, 0};
+        by_address.floor(start, hole);
+        removeHole(hole);
+        if (hole.size > size) addHole(start + size, hole.size - size);
+
+        block = {start, size};
+        rover = start + size;
+        return true;
+    }
+
+    void release(const MemoryExtent& block) override {
+        MemoryExtent merged = block;
+        MemoryExtent neighbour;
+        if (by_address.floor(block.start - 1, neighbour) && neighbour.start + neighbour.size == block.start) {
+            removeHole(neighbour);
+            merged.start = neighbour.start;
+            merged.size += neighbour.size;
+        }
+        if (by_address.ceil(block.start + block.size, neighbour) && neighbour.start == block.start + block.size) {
+            removeHole(neighbour);
+            merged.size += neighbour.size;
+        }
+        addHole(merged.start, merged.size);
+    }
+
+    bool reserve(const MemoryExtent& block) override {
+        MemoryExtent hole;
+        if (!by_address.floor(block.start, hole) || hole.start + hole.size < block.start + block.size) {
+            return false;
+        }
+        removeHole(hole);
+        if (block.start > hole.start) addHole(hole.start, block.start - hole.start);
+        int tail = hole.start + hole.size - (block.start + block.size);
+        if (tail > 0) addHole(block.start + block.size, tail);
+        return true;
+    }
+
+    int totalBytes() const override { return total; }
+
+    int freeBytes() const override { return free_bytes; }
+
+    int largestFreeExtent() const override { return by_size.empty() ? 0 : by_size.rbegin()->first; }
+
+    vector<MemoryExtent> freeExtents() const override {
+        vector<MemoryExtent> extents;
+        by_address.collect(extents);
+        return extents;
+    }
+
+private:
+    void addHole(int start, int size) {
+        by_address.insert(start, size);
+        by_size.insert({size, start});
+        free_bytes += size;
+    }
+
+    void removeHole(const MemoryExtent& hole) {
+        by_address.erase(hole.start);
+        by_size.erase({hole.size, hole.start});
+        free_bytes -= hole.size;
+    }
+
+    MemoryAllocatorType type;
+    ExtentTree by_address;
+    set<pair<int, int>> by_size;
+    int total = 0;
+    int free_bytes = 0;
+    int rover = 0;  // next-fit resumes here
+};
+
+// Binary buddy system. Blocks are 64 << order bytes and aligned to their
+// size; each order has a free list, threaded through per-unit link arrays so
+// a buddy can be unlinked in O(1), and a bitmap saying which blocks of that
+// order are free, which is all coalescing has to look at. A total that is not
+// a power of two is carved into aligned power-of-two regions; a sub-64-byte
+// tail is never handed out.
+class BuddyAllocator : public MemoryAllocator {
+public:
+    static const int MIN_BLOCK = 64;
+
+    const char* name() const override { return "buddy"; }
+
+    void reset(int total_bytes) override {
+        units = max(0, total_bytes) / MIN_BLOCK;
+        max_order = 0;
+        while ((2 << max_order) <= units) ++max_order;
+
+        next.assign(units, -1);
+        prev.assign(units, -1);
+        heads.assign(max_order + 1, -1);
+        free_bits.assign(max_order + 1, {});
+        for (int order = 0; order <= max_order; ++order) {
+            free_bits[order].assign(((units >> order) + 64) / 64, 0);
+        }
+        free_bytes = 0;
+
+        // Largest aligned blocks first, so every region is aligned to its size
+        int start = 0;
+        for (int order = max_order; order >= 0; --order) {
+            if (start + (1 << order) <= units) {
+                pushFree(order, start);
+                start += 1 << order;
+            }
+        }
+    }
+
+    bool allocate(int size, MemoryExtent& block) override {
+        int order = orderFor(size);
+        int found = order;
+        while (found <= max_order && heads[found] == -1) ++found;
+        if (order > max_order || found > max_order) return false;
+
+        int start = heads[found];
+        popFree(found, start);
+        // Split down, returning the upper halves
+        while (found > order) {
+            --found;
+            pushFree(found, start + (1 << found));
+        }
+        block = {start * MIN_BLOCK, MIN_BLOCK << order};
+        return true;
+    }
+
+    void release(const MemoryExtent& block) override {
+        int start = block.start / MIN_BLOCK;
+        int order = orderFor(block.size);
+        while (order < max_order) {
+            int buddy = start ^ (1 << order);
+            if (buddy + (1 << order) > units || !isFree(order, buddy)) break;
+            popFree(order, buddy);
+            start = min(start, buddy);
+            ++order;
+        }
+        pushFree(order, start);
+    }
+
+    // Blocks live where their size class puts them, so they cannot be moved
+    bool reserve(const MemoryExtent&) override { return false; }
+
+    int totalBytes() const override { return units * MIN_BLOCK; }
+
+    int freeBytes() const override { return free_bytes; }
+
+    int largestFreeExtent() const override {
+        for (int order = max_order; order >= 0; --order) {
+            if (heads[order] != -1) return MIN_BLOCK << order;
+        }
+        return 0;
+    }
+
+    vector<MemoryExtent> freeExtents() const override {
+        vector<MemoryExtent> extents;
+        for (int order = 0; order <= max_order; ++order) {
+            for (int unit = heads[order]; unit != -1; unit = next[unit]) {
+                extents.push_back({unit * MIN_BLOCK, MIN_BLOCK << order});
+            }
+        }
+        sort(extents.begin(), extents.end(),
+             [](const MemoryExtent& a, const MemoryExtent& b) { return a.start < b.start; });
+        return extents;
+    }
+
+private:
+    // Smallest order whose block holds size bytes
+    int orderFor(int size) const {
+        int order = 0;
+        while ((MIN_BLOCK << order) < size) ++order;
+        return order;
+    }
+
+    bool isFree(int order, int unit) const {
+        int index = unit >> order;
+        return (free_bits[order][index / 64] >> (index % 64)) & 1;
+    }
+
+    void pushFree(int order, int unit) {
+        int index = unit >> order;
+        free_bits[order][index / 64] |= 1ULL << (index % 64);
+        prev[unit] = -1;
+        next[unit] = heads[order];
+        if (heads[order] != -1) prev[heads[order]] = unit;
+        heads[order] = unit;
+        free_bytes += MIN_BLOCK << order;
+    }
+
+    void popFree(int order, int unit) {
+        int index = unit >> order;
+        free_bits[order][index / 64] &= ~(1ULL << (index % 64));
+        if (prev[unit] != -1) next[prev[unit]] = next[unit];
+        else heads[order] = next[unit];
+        if (next[unit] != -1) prev[next[unit]] = prev[unit];
+        free_bytes -= MIN_BLOCK << order;
+    }
+
+    int units = 0;  // MIN_BLOCK-sized units managed
+    int max_order = 0;
+    vector<int> next;  // free-list links, indexed by a block's first unit
+    vector<int> prev;
+    vector<int> heads;  // per order
+    vector<vector<uint64_t>> free_bits;  // per order, bit per block
+    int free_bytes = 0;
+};
+
+}  // namespace
+
+unique_ptr<MemoryAllocator> makeMemoryAllocator(MemoryAllocatorType type) {
+    if (type == ALLOC_BUDDY) return make_unique<BuddyAllocator>();
+    return make_unique<ExtentAllocator>(type);
+}
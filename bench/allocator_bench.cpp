@@ -0,0 +1,53 @@
+// allocator_bench.cpp
+// Allocation/free throughput of each memory allocator with 10k-12k live
+// blocks in a 64 MiB space, followed by a consistency check: no two live
+// blocks overlap, and live plus free bytes add up to the whole space.
+#include "../headers.h"
+#include <chrono>
+
+namespace {
+
+const int TOTAL_BYTES = 1 << 26;
+const int OPERATIONS = 400000;
+const size_t MIN_LIVE = 10000;
+const size_t MAX_LIVE = 12000;
+
+}  // namespace
+
+int main() {
+    printf("%-10s %8s %10s %8s %6s\n", "allocator", "live", "ns/op", "holes", "ok");
+    for (MemoryAllocatorType type : {ALLOC_FIRST_FIT, ALLOC_BEST_FIT, ALLOC_NEXT_FIT, ALLOC_BUDDY}) {
+        unique_ptr<MemoryAllocator> allocator = makeMemoryAllocator(type);
+        allocator->reset(TOTAL_BYTES);
+        vector<MemoryExtent> live;
+        Xoshiro256 rng(7);
+
+        // Below MIN_LIVE only allocate, then mix until MAX_LIVE
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < OPERATIONS; ++i) {
+            if (live.size() < MAX_LIVE && (live.size() < MIN_LIVE || rng.below(2))) {
+                MemoryExtent block;
+                if (allocator->allocate(64 << rng.below(6), block)) live.push_back(block);
+            } else {
+                size_t victim = rng.below(static_cast<uint32_t>(live.size()));
+                allocator->release(live[victim]);
+                live[victim] = live.back();
+                live.pop_back();
+            }
+        }
+        double ns_per_op = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / OPERATIONS;
+
+        sort(live.begin(), live.end(), [](const MemoryExtent& a, const MemoryExtent& b) { return a.start < b.start; });
+        bool ok = true;
+        long long used = 0;
+        for (size_t i = 0; i < live.size(); ++i) {
+            if (i > 0 && live[i - 1].start + live[i - 1].size > live[i].start) ok = false;
+            used += live[i].size;
+        }
+        ok = ok && used + allocator->freeBytes() == allocator->totalBytes();
+        printf("%-10s %8zu %10.0f %8zu %6s\n", allocator->name(), live.size(), ns_per_op,
+               allocator->freeExtents().size(), ok ? "yes" : "NO");
+        if (!ok) return 1;
+    }
+    return 0;
+}
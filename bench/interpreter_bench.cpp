@@ -0,0 +1,99 @@
+// interpreter_bench.cpp
+// Instructions per second of the bytecode interpreter against the string
+// interpreter it replaced, which re-tokenized every instruction with an
+// istringstream and kept variables in a map. That interpreter is reproduced
+// below, minus PRINT and SLEEP, as the "before" column.
+#include "../headers.h"
+#include <chrono>
+
+namespace {
+
+const int RUNS = 200000;
+
+const vector<string> PROGRAM = {
+    "DECLARE var1 5",
+    "ADD var2 var1 7",
+    "SUBTRACT var3 var2 var1",
+    "ADD x var3 12",
+    "FOR ADD var1 var1 1, SUBTRACT var2 var2 1 10",
+};
+const int INSTRUCTIONS_PER_RUN = 4 + 1 + 2 * 10;
+
+// ---- Before: the string interpreter ----
+
+unordered_map<string, uint16_t> g_string_variables;
+
+uint16_t stringValue(const string& varOrValue) {
+    auto it = g_string_variables.find(varOrValue);
+    if (it != g_string_variables.end()) return it->second;
+    try {
+        return static_cast<uint16_t>(stoi(varOrValue));
+    } catch (const exception&) {
+        return 0;
+    }
+}
+
+void runStrings(const vector<string>& instructions) {
+    for (const string& instruction : instructions) {
+        istringstream iss(instruction);
+        string command;
+        iss >> command;
+        if (command == "DECLARE") {
+            string var, value;
+            if (iss >> var >> value) g_string_variables[var] = stringValue(value);
+        } else if (command == "ADD" || command == "SUBTRACT") {
+            string var1, op2, op3;
+            if (iss >> var1 >> op2 >> op3) {
+                if (!g_string_variables.count(var1)) g_string_variables[var1] = 0;
+                int32_t result = command == "ADD" ? stringValue(op2) + stringValue(op3)
+                                                  : stringValue(op2) - stringValue(op3);
+                g_string_variables[var1] = static_cast<uint16_t>(min(max(result, 0), 65535));
+            }
+        } else if (command == "FOR") {
+            string line;
+            getline(iss, line);
+            size_t last_space = line.find_last_of(' ');
+            int repeats = stoi(line.substr(last_space + 1));
+            vector<string> body;
+            istringstream body_stream(line.substr(0, last_space));
+            string single;
+            while (getline(body_stream, single, ',')) {
+                single.erase(0, single.find_first_not_of(" \t"));
+                single.erase(single.find_last_not_of(" \t") + 1);
+                if (!single.empty()) body.push_back(single);
+            }
+            for (int i = 0; i < repeats; ++i) runStrings(body);
+        }
+    }
+}
+
+double seconds(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+}  // namespace
+
+int main() {
+    auto start = chrono::steady_clock::now();
+    for (int run = 0; run < RUNS; ++run) runStrings(PROGRAM);
+    double string_seconds = seconds(start);
+
+    PCB process(1, "bench", RUNNING, time(nullptr), 0, 0, "", 0, 64);
+    process.registers.reset();
+    Program program = compileProgram(PROGRAM, process.registers, seededVariableNames());
+    start = chrono::steady_clock::now();
+    for (int run = 0; run < RUNS; ++run) runProgram(program, 0, program.code.size(), 0, &process);
+    double bytecode_seconds = seconds(start);
+
+    // A screen -c program compiles once per run
+    start = chrono::steady_clock::now();
+    for (int run = 0; run < RUNS; ++run) executeInstructionSet(PROGRAM, 0, &process);
+    double compile_seconds = seconds(start);
+
+    double instructions = static_cast<double>(RUNS) * INSTRUCTIONS_PER_RUN;
+    printf("%-28s %14s\n", "interpreter", "M instr/s");
+    printf("%-28s %14.2f\n", "string (before)", instructions / string_seconds / 1e6);
+    printf("%-28s %14.2f\n", "bytecode", instructions / bytecode_seconds / 1e6);
+    printf("%-28s %14.2f\n", "bytecode, compiled each run", instructions / compile_seconds / 1e6);
+    return 0;
+}
@@ -0,0 +1,77 @@
+// ready_queue_bench.cpp
+// Contention on the ready queue: the lock-free ring behind g_ready_queue
+// against the mutex-guarded std::queue it replaced. Producers and consumers
+// come in pairs, like process generation and RR requeues against the cores.
+#include "../headers.h"
+#include <chrono>
+#include <queue>
+
+namespace {
+
+const int ITEMS_PER_PRODUCER = 200000;
+const size_t CAPACITY = 65536;
+
+// The old g_ready_queue: a std::queue behind g_ready_queue_mutex
+class MutexQueue {
+public:
+    bool tryPush(PCB* value) {
+        lock_guard<mutex> lock(queue_mutex);
+        processes.push(value);
+        return true;
+    }
+    bool tryPop(PCB*& value) {
+        lock_guard<mutex> lock(queue_mutex);
+        if (processes.empty()) return false;
+        value = processes.front();
+        processes.pop();
+        return true;
+    }
+
+private:
+    mutex queue_mutex;
+    queue<PCB*> processes;
+};
+
+// Million operations (pushes plus pops) per second
+template <typename Queue>
+double run(Queue& ready_queue, int pairs) {
+    atomic<long long> popped(0);
+    long long total = static_cast<long long>(pairs) * ITEMS_PER_PRODUCER;
+    vector<thread> threads;
+    auto start = chrono::steady_clock::now();
+    for (int p = 0; p < pairs; ++p) {
+        threads.emplace_back([&ready_queue, p] {
+            for (int i = 1; i <= ITEMS_PER_PRODUCER; ++i) {
+                PCB* value = reinterpret_cast<PCB*>(static_cast<uintptr_t>(p) << 32 | i);
+                while (!ready_queue.tryPush(value)) this_thread::yield();
+            }
+        });
+        threads.emplace_back([&ready_queue, &popped, total] {
+            PCB* value;
+            while (popped.load(memory_order_relaxed) < total) {
+                if (ready_queue.tryPop(value)) {
+                    popped.fetch_add(1, memory_order_relaxed);
+                } else {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& worker : threads) worker.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return 2.0 * total / seconds / 1e6;
+}
+
+}  // namespace
+
+int main() {
+    printf("%-8s %14s %14s\n", "threads", "ring Mops/s", "mutex Mops/s");
+    for (int pairs = 1; pairs <= 16; pairs *= 2) {
+        MPMCQueue<PCB*> ring(CAPACITY);
+        MutexQueue locked;
+        double ring_rate = run(ring, pairs);
+        double mutex_rate = run(locked, pairs);
+        printf("%-8d %14.2f %14.2f\n", 2 * pairs, ring_rate, mutex_rate);
+    }
+    return 0;
+}
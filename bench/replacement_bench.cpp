@@ -0,0 +1,188 @@
+// replacement_bench.cpp
+// Fault-handling throughput of each replacement policy. One process touches
+// four times as many pages as there are frames, through simulateMemoryAccess
+// on the menu thread, so every access takes the paging lock and most of them
+// fault and evict. The baseline column replays the same page stream through
+// a copy of the pager this repo started with.
+#include "../headers.h"
+#include <chrono>
+
+namespace {
+
+const int ACCESSES = 400000;
+
+struct Result {
+    double faults_per_second;
+    double hit_ratio;
+};
+
+// The original pager, kept as it was apart from its backing-store logging:
+// one page table shared by every process, searched by name on each access,
+// a linear scan for a free frame, and findLRUPage's scan over time_t stamps.
+// Stamps only have one-second resolution, so pages touched within the current
+// second are never chosen as victims.
+namespace old_pager {
+
+struct OldPage {
+    int page_number;
+    string process_name;
+    bool is_in_memory;
+    int frame_number;
+    time_t last_access_time;
+};
+
+vector<OldPage> page_table;
+vector<bool> frame_table;
+long long faults = 0;
+long long hits = 0;
+
+int findLRUPage() {
+    time_t oldest_time = time(nullptr);
+    int lru_index = -1;
+
+    for (int i = 0; i < page_table.size(); i++) {
+        if (page_table[i].is_in_memory && page_table[i].last_access_time < oldest_time) {
+            oldest_time = page_table[i].last_access_time;
+            lru_index = i;
+        }
+    }
+
+    return lru_index;
+}
+
+void pageIn(const string& process_name, int page_number) {
+    int frame_to_use = -1;
+    int total_frames = static_cast<int>(frame_table.size());
+
+    for (int i = 0; i < total_frames; i++) {
+        if (!frame_table[i]) {
+            frame_to_use = i;
+            break;
+        }
+    }
+
+    if (frame_to_use == -1) {
+        int lru_page_idx = findLRUPage();
+        if (lru_page_idx != -1) {
+            page_table[lru_page_idx].is_in_memory = false;
+            frame_to_use = page_table[lru_page_idx].frame_number;
+        }
+    }
+
+    if (frame_to_use != -1) {
+        frame_table[frame_to_use] = true;
+
+        bool found = false;
+        for (auto& page : page_table) {
+            if (page.process_name == process_name && page.page_number == page_number) {
+                page.is_in_memory = true;
+                page.frame_number = frame_to_use;
+                page.last_access_time = time(nullptr);
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) {
+            page_table.push_back({page_number, process_name, true, frame_to_use, time(nullptr)});
+        }
+    }
+}
+
+void access(const string& process_name, int page_num) {
+    bool page_found = false;
+    for (auto& page : page_table) {
+        if (page.process_name == process_name && page.page_number == page_num) {
+            if (page.is_in_memory) {
+                page.last_access_time = time(nullptr);
+                page_found = true;
+            }
+            break;
+        }
+    }
+
+    if (page_found) {
+        hits++;
+    } else {
+        pageIn(process_name, page_num);
+        faults++;
+    }
+}
+
+}  // namespace old_pager
+
+// Same process, seed and pattern as run(), so the same pages in the same order
+Result runBaseline(int frames) {
+    PCB process(0, "bench", RUNNING, time(nullptr), 0, 0, "", -1, 4 * frames * g_mem_per_frame);
+    process.program_seed = 42;
+    int count = min(max(config_pages_per_instruction, 1), MAX_PAGES_PER_INSTRUCTION);
+    vector<int> stream(static_cast<size_t>(ACCESSES) * count);
+    for (int& page : stream) {
+        page = nextAccessPage(&process);
+    }
+
+    old_pager::page_table.clear();
+    old_pager::frame_table.assign(frames, false);
+    old_pager::faults = 0;
+    old_pager::hits = 0;
+    string name = "bench";
+
+    auto start = chrono::steady_clock::now();
+    for (int page : stream) {
+        old_pager::access(name, page);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long long hits = old_pager::hits;
+    long long faults = old_pager::faults;
+    return {faults / seconds, 100.0 * hits / max(1LL, hits + faults)};
+}
+
+Result run(PageReplacementType policy, int frames) {
+    config_page_replacement = policy;
+    g_max_overall_mem = frames * g_mem_per_frame;
+    g_min_mem_per_proc = g_mem_per_frame;
+    g_max_mem_per_proc = g_mem_per_frame;
+    initializePaging();
+
+    // Paged in on demand, without a block: only the access stream uses its size
+    PCB process(0, "bench", RUNNING, time(nullptr), 0, 0, "", -1, 4 * frames * g_mem_per_frame);
+    process.program_seed = 42;
+    registerProcess(&process);
+
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ACCESSES; ++i) {
+        simulateMemoryAccess(&process);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    closePagingSystem();
+
+    long long hits = g_page_hits.load();
+    long long faults = g_page_faults.load();
+    return {faults / seconds, 100.0 * hits / max(1LL, hits + faults)};
+}
+
+}  // namespace
+
+int main() {
+    g_mem_per_frame = 16;
+    const PageReplacementType policies[] = {REPLACE_FIFO, REPLACE_LRU, REPLACE_CLOCK, REPLACE_ARC};
+
+    for (AccessPattern pattern : {ACCESS_ZIPF, ACCESS_UNIFORM}) {
+        config_access_pattern = pattern;
+        printf("%s accesses\n", accessPatternName());
+        printf("%-8s %-8s %14s %10s %16s %12s\n", "frames", "policy", "faults/s", "hit %", "old LRU faults/s",
+               "old hit %");
+        for (int frames : {16, 256, 4096}) {
+            Result baseline = runBaseline(frames);
+            for (PageReplacementType policy : policies) {
+                Result result = run(policy, frames);
+                printf("%-8d %-8s %14.0f %10.2f %16.0f %12.2f\n", frames, replacementPolicyName(),
+                       result.faults_per_second, result.hit_ratio, baseline.faults_per_second, baseline.hit_ratio);
+            }
+        }
+        printf("\n");
+    }
+    closeSwapDevice();
+    return 0;
+}
@@ -0,0 +1,54 @@
+// tick_bench.cpp
+// Cost of a clock tick as the core count grows. In virtual time the clock
+// advances as soon as every core has parked, so with cores that do nothing
+// but wait for the next tick, the time per tick is the wake/park overhead of
+// the per-core slots alone.
+#include "../headers.h"
+#include <chrono>
+
+namespace {
+
+const chrono::milliseconds RUN_TIME(300);
+
+// Microseconds per tick with cores parking delay ticks ahead each time
+double run(int cores, unsigned long long delay) {
+    config_num_cpu = cores;
+    initializeCores();
+    g_exit_flag = false;
+    g_cpu_ticks = 0;
+
+    vector<thread> workers;
+    for (int core_id = 0; core_id < cores; ++core_id) {
+        workers.emplace_back([core_id, delay] {
+            t_core_id = core_id;
+            while (!g_exit_flag.load()) {
+                waitUntilTick(g_cpu_ticks.load() + delay);
+            }
+        });
+    }
+    thread ticker(tick_generator_thread);
+
+    auto start = chrono::steady_clock::now();
+    this_thread::sleep_for(RUN_TIME);
+    unsigned long long ticks = g_cpu_ticks.load();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    g_exit_flag = true;
+    wakeAllCores();
+    ticker.join();
+    for (auto& worker : workers) worker.join();
+    return ticks > 0 ? seconds * 1e6 / ticks : 0.0;
+}
+
+}  // namespace
+
+int main() {
+    g_virtual_time = true;
+    printf("%-8s %16s %16s\n", "cores", "us/tick delay 1", "us/tick delay 4");
+    for (int cores = 1; cores <= 128; cores *= 2) {
+        double every_tick = run(cores, 1);
+        double every_fourth = run(cores, 4);
+        printf("%-8d %16.2f %16.2f\n", cores, every_tick, every_fourth);
+    }
+    return 0;
+}
@@ -9,6 +9,7 @@ int config_batch_process_freq;
 int config_min_ins;
 int config_max_ins;
 int config_delay_per_exec = 4;  // Default to 4 ticks per instruction
+uint64_t config_random_seed = 0;  // 0 = pick one at startup
 int g_max_overall_mem;
 int g_mem_per_frame;
 int g_min_mem_per_proc;
@@ -54,11 +55,93 @@ void readConfigFile() {
             configFile >> g_min_mem_per_proc;
         } else if (key == "max-mem-per-proc") {
             configFile >> g_max_mem_per_proc;
+        } else if (key == "random-seed") {
+            configFile >> config_random_seed;
+        } else if (key == "compaction-threshold") {
+            configFile >> config_compaction_threshold;
+        } else if (key == "compaction-stop-threshold") {
+            configFile >> config_compaction_stop_threshold;
+        } else if (key == "audit-interval") {
+            configFile >> config_audit_interval;
+        } else if (key == "memory-allocator") {
+            string allocator;
+            configFile >> allocator;
+            if (allocator.front() == '"' && allocator.back() == '"') {
+                allocator = allocator.substr(1, allocator.length() - 2);
+            }
+            if (allocator == "first-fit") {
+                config_memory_allocator = ALLOC_FIRST_FIT;
+            } else if (allocator == "best-fit") {
+                config_memory_allocator = ALLOC_BEST_FIT;
+            } else if (allocator == "next-fit") {
+                config_memory_allocator = ALLOC_NEXT_FIT;
+            } else if (allocator == "buddy") {
+                config_memory_allocator = ALLOC_BUDDY;
+            } else {
+                config_memory_allocator = ALLOC_FIRST_FIT;
+                cout << "Warning: Unknown memory-allocator '" << allocator << "', defaulting to first-fit" << endl;
+            }
+        } else if (key == "page-replacement") {
+            string policy;
+            configFile >> policy;
+            if (policy.front() == '"' && policy.back() == '"') {
+                policy = policy.substr(1, policy.length() - 2);
+            }
+            if (policy == "lru" || policy == "LRU") {
+                config_page_replacement = REPLACE_LRU;
+            } else if (policy == "fifo" || policy == "FIFO") {
+                config_page_replacement = REPLACE_FIFO;
+            } else if (policy == "clock" || policy == "CLOCK") {
+                config_page_replacement = REPLACE_CLOCK;
+            } else if (policy == "arc" || policy == "ARC") {
+                config_page_replacement = REPLACE_ARC;
+            } else {
+                config_page_replacement = REPLACE_LRU;
+                cout << "Warning: Unknown page-replacement policy '" << policy << "', defaulting to LRU" << endl;
+            }
+        } else if (key == "access-pattern") {
+            string pattern;
+            configFile >> pattern;
+            if (pattern.front() == '"' && pattern.back() == '"') {
+                pattern = pattern.substr(1, pattern.length() - 2);
+            }
+            if (pattern == "sequential") {
+                config_access_pattern = ACCESS_SEQUENTIAL;
+            } else if (pattern == "uniform") {
+                config_access_pattern = ACCESS_UNIFORM;
+            } else if (pattern == "zipf" || pattern == "zipfian") {
+                config_access_pattern = ACCESS_ZIPF;
+            } else if (pattern == "phased") {
+                config_access_pattern = ACCESS_PHASED;
+            } else {
+                config_access_pattern = ACCESS_ZIPF;
+                cout << "Warning: Unknown access-pattern '" << pattern << "', defaulting to zipf" << endl;
+            }
+        } else if (key == "pages-per-instruction") {
+            configFile >> config_pages_per_instruction;
+        } else if (key == "backing-store-format") {
+            string format;
+            configFile >> format;
+            if (format.front() == '"' && format.back() == '"') {
+                format = format.substr(1, format.length() - 2);
+            }
+            if (format == "binary") {
+                config_backing_store_format = BACKING_STORE_BINARY;
+            } else if (format == "text") {
+                config_backing_store_format = BACKING_STORE_TEXT;
+            } else {
+                config_backing_store_format = BACKING_STORE_TEXT;
+                cout << "Warning: Unknown backing-store format '" << format << "', defaulting to text" << endl;
+            }
         } else {
             string skip;
             configFile >> skip;
         }
     }
+    if (config_random_seed == 0) {
+        random_device rd;
+        config_random_seed = (static_cast<uint64_t>(rd()) << 32) | rd();
+    }
     initializeMemory();
     configFile.close();
 }
@@ -76,6 +159,27 @@ void printConfigVars() {
     cout << "mem-per-frame: " << g_mem_per_frame << " bytes" << endl;
     cout << "min-mem-per-proc: " << g_min_mem_per_proc << " bytes" << endl;
     cout << "max-mem-per-proc: " << g_max_mem_per_proc << " bytes" << endl;
+    cout << "random-seed: " << config_random_seed << endl;
+    cout << "memory-allocator: " << memoryAllocatorName() << endl;
+    if (config_compaction_threshold <= 0 || config_memory_allocator == ALLOC_BUDDY) {
+        cout << "compaction-threshold: off" << endl;
+    } else {
+        cout << "compaction-threshold: " << config_compaction_threshold << "%, stops at "
+             << config_compaction_stop_threshold << "%" << endl;
+    }
+    cout << "page-replacement: " << replacementPolicyName() << endl;
+    cout << "access-pattern: " << accessPatternName() << ", " << config_pages_per_instruction << " page(s) per instruction" << endl;
+    cout << "backing-store-format: " << (config_backing_store_format == BACKING_STORE_BINARY ? "binary" : "text") << endl;
     cout << "total-frames: " << (g_max_overall_mem / g_mem_per_frame) << endl;
-    cout << "[System Info] Tick Duration: " << TICK_DURATION_MS << " ms" << endl;
+#ifdef CSOPESY_CHECKED
+    cout << "audit-interval: " << config_audit_interval << " (checked build)" << endl;
+#endif
+    if (g_virtual_time) {
+        cout << "[System Info] Tick Duration: virtual (ticks advance as soon as all cores are done)" << endl;
+        cout << "  delay-per-exec 0 runs quantum-cycles instructions per core per tick" << endl;
+        cout << "  compaction runs one slice between ticks instead of on its own thread" << endl;
+        cout << "  idle cores recheck the queues every tick instead of waiting for an event" << endl;
+    } else {
+        cout << "[System Info] Tick Duration: " << TICK_DURATION_MS << " ms" << endl;
+    }
 }
\ No newline at end of file
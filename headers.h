@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include <queue>
+#include <deque>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -19,6 +20,10 @@
 #include <map>
 #include <unordered_map>
 #include <random>
+#include <cstdint>
+#include <algorithm>
+#include <charconv>
+#include <climits>
 
 using namespace std;
 
@@ -34,6 +39,182 @@ enum SchedulerType {
     RR
 };
 
+// Per-process variable storage: 64 bytes of values and a mask. A name is
+// bound to a fixed slot when the program using it is compiled, and the names
+// live in that program's symbol table (Program::names), so reads and writes
+// are an index into this small array owned by the process. Since each process
+// runs on one core at a time, no locking is needed; a context switch is just
+// switching to the next process's register file.
+struct RegisterFile {
+    static const int MAX_REGISTERS = 32;  // 64-byte symbol table of uint16 values
+
+    uint16_t values[MAX_REGISTERS] = {};
+    uint32_t defined = 0;  // bit per slot: the variable has been written
+
+    void reset();  // var1..var3 in slots 0..2 declared 0, nothing else written
+};
+
+// Compiled instruction set. Programs are compiled once into a flat array of
+// 8-byte instructions whose operands are register slots or immediates, and
+// run by a switch-dispatch loop instead of re-tokenizing strings.
+enum OpCode : uint8_t {
+    OP_DECLARE,   // a = slot, b = value
+    OP_ADD,       // a = slot, b/c = operands
+    OP_SUBTRACT,  // a = slot, b/c = operands
+    OP_PRINT,     // a = index into Program::strings
+    OP_SLEEP,     // b = ticks
+    OP_FOR        // a = body length (body follows inline), b = repeats
+};
+
+const uint8_t IMM_B = 1 << 0;  // operand b is an immediate, not a slot
+const uint8_t IMM_C = 1 << 1;  // operand c is an immediate, not a slot
+const uint16_t NO_SLOT = 0xFFFF;
+
+struct Instruction {
+    uint8_t op;
+    uint8_t flags;
+    uint16_t a;
+    uint16_t b;
+    uint16_t c;
+};
+
+// Piece of a precompiled PRINT message: bytes [offset, offset + length) of
+// the message, or, when slot is set and the variable has been written, that
+// variable's value.
+struct PrintSegment {
+    uint32_t offset;
+    uint32_t length;
+    uint16_t slot;
+};
+
+struct Program {
+    vector<string> names;  // slot -> variable name; carried from chunk to chunk
+    vector<Instruction> code;
+    vector<uint32_t> statements;  // code offset where each source statement starts
+    vector<string> strings;
+    vector<PrintSegment> segments;
+    vector<uint32_t> template_begin;  // segments of strings[i] are [template_begin[i], template_begin[i + 1])
+    bool legacy_print = false;        // names PRINT templates cannot express exactly
+
+    int findVariable(const string& name) const;              // slot index, or -1 if unbound
+    int bindVariable(const string& name, RegisterFile& regs);  // existing or new slot, -1 if full
+};
+
+// Names of the slots RegisterFile::reset seeds
+const vector<string>& seededVariableNames();
+
+const int PROGRAM_CHUNK_SIZE = 256;  // statements generated at a time
+
+const int LOG_BUFFER_CAPACITY = 64;  // PRINT records kept in memory per process
+
+// Fixed-size PRINT log of one process. When it fills up the records are
+// appended to the process's output_filename and the slots reused, so memory
+// per process stays bounded however long it runs.
+struct LogBuffer {
+    mutex buffer_mutex;  // only the core running the process and screen -r take it
+    string records[LOG_BUFFER_CAPACITY];
+    int count = 0;
+    size_t spilled = 0;  // records already written to output_filename
+};
+
+// Contiguous range of the process memory space
+struct MemoryExtent {
+    int start;
+    int size;
+};
+
+// Entry of a process's page table, which is indexed by page number
+struct Page {
+    bool is_in_memory = false;
+    int frame_number = -1;
+    unsigned long long last_access_tick = 0;  // g_cpu_ticks at the last access
+    int swap_slot = -1;     // where the page's contents live while evicted
+    bool is_dirty = false;  // frame differs from the swap slot
+};
+
+struct PCB;
+
+inline int countTrailingZeros(uint64_t word) {  // word must be nonzero
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Two-level bitmap of free frames. A set bit in a leaf word marks a free
+// frame; a set bit in a summary word marks a leaf word with any free frame.
+// Finding the lowest free frame is two ctz scans per 4096 frames, and the free
+// count is kept alongside.
+class FreeFrameBitmap {
+public:
+    void reset(int total_frames) {
+        frame_count = total_frames;
+        free_count = total_frames;
+        leaves.assign((total_frames + 63) / 64, ~0ULL);
+        if (total_frames % 64) leaves.back() = (1ULL << (total_frames % 64)) - 1;
+        summary.assign((leaves.size() + 63) / 64, 0);
+        for (size_t leaf = 0; leaf < leaves.size(); ++leaf) {
+            if (leaves[leaf]) summary[leaf / 64] |= 1ULL << (leaf % 64);
+        }
+    }
+
+    // Lowest free frame, now marked used, or -1 if none is free
+    int allocate() {
+        for (size_t group = 0; group < summary.size(); ++group) {
+            if (!summary[group]) continue;
+            size_t leaf = group * 64 + countTrailingZeros(summary[group]);
+            int frame = static_cast<int>(leaf * 64 + countTrailingZeros(leaves[leaf]));
+            take(frame);
+            return frame;
+        }
+        return -1;
+    }
+
+    void take(int frame) {
+        size_t leaf = frame / 64;
+        leaves[leaf] &= ~(1ULL << (frame % 64));
+        if (!leaves[leaf]) summary[leaf / 64] &= ~(1ULL << (leaf % 64));
+        --free_count;
+    }
+
+    void release(int frame) {
+        size_t leaf = frame / 64;
+        leaves[leaf] |= 1ULL << (frame % 64);
+        summary[leaf / 64] |= 1ULL << (leaf % 64);
+        ++free_count;
+    }
+
+    int freeCount() const { return free_count; }
+    int totalCount() const { return frame_count; }
+
+private:
+    vector<uint64_t> leaves;
+    vector<uint64_t> summary;
+    int frame_count = 0;
+    int free_count = 0;
+};
+
+// Inverted page table: which process page, if any, occupies each frame
+struct FrameEntry {
+    int pid = 0;  // 0: frame is free
+    int page_number = -1;
+};
+
+// Per-process position in its simulated memory access stream (access.cpp).
+// Only the core running the process touches it.
+struct AccessState {
+    bool initialized = false;
+    int pages = 0;  // spanned by memory_requirement
+    uint64_t rng_state = 0;
+    int next_page = 0;   // sequential cursor
+    int phase_base = 0;  // first page of the phased working set
+    int phase_left = 0;  // accesses before it moves
+    double zipf_h_x1 = 0, zipf_h_n = 0, zipf_s = 0;  // sampler constants for this page count
+};
+
 struct PCB {
     int id;
     string name;
@@ -44,15 +225,250 @@ struct PCB {
     string output_filename;
     int core_id; 
     int remaining_quantum;
-    vector<string> logs; 
+    LogBuffer logs;
+    RegisterFile registers;
+    uint64_t program_seed = 0;  // generated programs are a pure function of this
+    Program program;            // compiled chunk program_chunk of the program
+    int program_chunk = -1;
     atomic<bool> is_allocated{false};
     int memory_requirement;
+    MemoryExtent memory_block{-1, 0};  // valid while is_allocated
+    int memory_requested = 0;          // bytes asked of the allocator for memory_block
+    unsigned long long ready_tick = 0;  // tick at which the process last became ready
+    vector<Page> page_table;            // guarded by g_paging_mutex
+    AccessState access;
 
     PCB(int p_id, const string& p_name, ProcessState p_state, time_t p_creation_time, 
         int p_instr_total, int p_instr_exec, const string& p_filename, int p_core_id, int p_mem_req)
       : id(p_id), name(p_name), state(p_state), creation_time(p_creation_time),
         instructions_total(p_instr_total), instructions_executed(p_instr_exec), 
-        output_filename(p_filename), core_id(p_core_id), remaining_quantum(0), logs(), memory_requirement(p_mem_req) {}
+        output_filename(p_filename), core_id(p_core_id), remaining_quantum(0), memory_requirement(p_mem_req) {}
+};
+
+// splitmix64 step: advances state and returns a well-mixed 64-bit value.
+inline uint64_t splitmix64(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Seed of an independent child stream. Splitting the master seed by process
+// id, and a process seed by chunk index, makes every random choice in a run a
+// pure function of the master seed.
+inline uint64_t deriveSeed(uint64_t parent, uint64_t stream) {
+    uint64_t state = parent ^ (stream * 0xD1B54A32D192ED03ULL);
+    splitmix64(state);
+    return splitmix64(state);
+}
+
+// xoshiro256** generator: 32 bytes of state and a handful of shifts per draw.
+// Instances are never shared between threads.
+class Xoshiro256 {
+public:
+    using result_type = uint64_t;
+
+    explicit Xoshiro256(uint64_t seed) {
+        for (auto& word : state) word = splitmix64(seed);
+    }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return UINT64_MAX; }
+
+    result_type operator()() {
+        uint64_t result = rotl(state[1] * 5, 7) * 9;
+        uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, bound) by multiply-shift; identical on every platform,
+    // unlike the standard distributions.
+    uint32_t below(uint32_t bound) {
+        return static_cast<uint32_t>(((*this)() >> 32) * bound >> 32);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+    uint64_t state[4];
+};
+
+// Bounded lock-free multi-producer/multi-consumer ring buffer (Vyukov-style).
+// Each cell carries a sequence number that tells producers and consumers whose
+// turn it is, so neither side ever takes a lock. Capacity must be a power of two.
+template <typename T>
+class MPMCQueue {
+public:
+    explicit MPMCQueue(size_t capacity)
+      : buffer(capacity), mask(capacity - 1), enqueue_pos(0), dequeue_pos(0) {
+        for (size_t i = 0; i < capacity; ++i) {
+            buffer[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+
+    // Returns false if the ring is full.
+    bool tryPush(const T& value) {
+        size_t pos = enqueue_pos.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = buffer[pos & mask];
+            size_t seq = cell.sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    cell.data = value;
+                    cell.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    // Returns false if the ring is empty.
+    bool tryPop(T& value) {
+        size_t pos = dequeue_pos.load(memory_order_relaxed);
+        while (true) {
+            Cell& cell = buffer[pos & mask];
+            size_t seq = cell.sequence.load(memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    value = cell.data;
+                    cell.sequence.store(pos + mask + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(memory_order_relaxed);
+            }
+        }
+    }
+
+    // Approximate while producers/consumers are active, exact when quiescent.
+    size_t size() const {
+        size_t head = dequeue_pos.load(memory_order_acquire);
+        size_t tail = enqueue_pos.load(memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const { return mask + 1; }
+
+private:
+    struct Cell {
+        atomic<size_t> sequence;
+        T data;
+    };
+
+    vector<Cell> buffer;
+    const size_t mask;
+    alignas(64) atomic<size_t> enqueue_pos;
+    alignas(64) atomic<size_t> dequeue_pos;
+};
+
+// Lock hierarchy. A thread holding one of these locks may only go on to take
+// locks further down the list:
+//   1. g_process_lists_mutex      finished list, process storage
+//   2. CoreRunQueue::queue_mutex  one run queue at a time
+//   3. g_memory_mutex             allocator, process memory blocks
+//   4. g_paging_mutex             frame table, page tables, swap, policy
+//   5. g_registry_mutex           PID registry
+//   6. LogBuffer::buffer_mutex
+//   7. outputMutex
+// CoreTickSlot::slot_mutex and the compactor's wait mutex are only held
+// around a wait or notify; the virtual-time parked-core mutex is only taken
+// under a slot mutex or on its own. SoftwareTlb::store_mutex is a leaf below
+// g_paging_mutex. Running slots (g_running_processes) are atomics
+// and take no lock at all.
+
+struct LockStats {
+    const char* name;
+    long long acquisitions;
+    long long contended;  // had to wait
+    long long wait_ns;
+    long long hold_ns;
+};
+
+// A mutex that counts acquisitions and how long they waited and held it. An
+// uncontended lock costs a try_lock and a clock read on top of the mutex.
+class ProfiledMutex {
+public:
+    explicit ProfiledMutex(const char* p_name) : lock_name(p_name) {}
+
+    void lock() {
+        if (inner.try_lock()) {
+            acquired_at = chrono::steady_clock::now();
+        } else {
+            auto wait_start = chrono::steady_clock::now();
+            inner.lock();
+            acquired_at = chrono::steady_clock::now();
+            contended.fetch_add(1, memory_order_relaxed);
+            wait_ns.fetch_add(nanoseconds(acquired_at - wait_start), memory_order_relaxed);
+        }
+        acquisitions.fetch_add(1, memory_order_relaxed);
+    }
+
+    bool try_lock() {
+        if (!inner.try_lock()) return false;
+        acquired_at = chrono::steady_clock::now();
+        acquisitions.fetch_add(1, memory_order_relaxed);
+        return true;
+    }
+
+    void unlock() {
+        hold_ns.fetch_add(nanoseconds(chrono::steady_clock::now() - acquired_at), memory_order_relaxed);
+        inner.unlock();
+    }
+
+    LockStats stats() const {
+        return {lock_name, acquisitions.load(), contended.load(), wait_ns.load(), hold_ns.load()};
+    }
+
+    void resetStats() {
+        acquisitions = 0;
+        contended = 0;
+        wait_ns = 0;
+        hold_ns = 0;
+    }
+
+private:
+    static long long nanoseconds(chrono::steady_clock::duration d) {
+        return chrono::duration_cast<chrono::nanoseconds>(d).count();
+    }
+
+    mutex inner;
+    const char* lock_name;
+    chrono::steady_clock::time_point acquired_at;  // written only by the holder
+    atomic<long long> acquisitions{0};
+    atomic<long long> contended{0};
+    atomic<long long> wait_ns{0};
+    atomic<long long> hold_ns{0};
+};
+
+// Per-core run queue. The owning core pops from the front and requeues RR
+// processes at the back; idle peers steal from the back.
+struct CoreRunQueue {
+    ProfiledMutex queue_mutex{"run queues"};
+    deque<PCB*> processes;
+};
+
+// Per-core wake slot. A parked core sleeps on its own condition variable and
+// publishes the tick it is waiting for (0 while busy), so the tick thread
+// wakes only the cores whose target has arrived instead of broadcasting to
+// all of them. Virtual time only advances once every core is parked.
+struct CoreTickSlot {
+    mutex slot_mutex;
+    condition_variable slot_cv;
+    atomic<unsigned long long> waiting_for_tick{0};
+    atomic<bool> waiting_for_event{false};
 };
 
 // Forward declarations
@@ -67,41 +483,57 @@ string getCurrentTimestampWithMillis();
 string format_timestamp_for_display(time_t t);
 void tick_generator_thread();
 void stopAndResetScheduler();
-void schedulerThread();
 void clearScreen();
 string getSystemReport();
-void createTestProcesses(const string& screenName);
+void createTestProcesses();
 void menuSession();
 void screenSession(Console& screen);
 void fcfs_worker_thread(int core_id);
 void rr_worker_thread(int core_id);
+void pushReadyProcess(PCB* process);
+void initializeCores();
+void waitUntilTick(unsigned long long target_tick);
+void wakeAllCores();
+size_t readyProcessCount();
+void notifyDispatchEvent();
+void recordDispatchLatency(unsigned long long ticks);
+double averageDispatchLatency();
+// exact is false when the percentile lies past the histogram; the result is
+// then only a lower bound.
+unsigned long long dispatchLatencyPercentile(double percentile, bool& exact);
+unsigned long long maxDispatchLatency();
+vector<LockStats> collectLockStats();  // run queues are summed into one entry
+void resetLockStats();
 
 // Global variables
-extern queue<PCB*> g_ready_queue;
-extern mutex g_ready_queue_mutex;
-extern vector<PCB*> g_running_processes;
+extern const size_t READY_QUEUE_CAPACITY;
+extern MPMCQueue<PCB*> g_ready_queue;
+extern unique_ptr<atomic<PCB*>[]> g_running_processes;  // per core, nullptr when idle
 extern vector<PCB*> g_finished_processes;
-extern mutex g_process_lists_mutex;
+extern ProfiledMutex g_process_lists_mutex;
 extern atomic<bool> g_exit_flag;
 extern vector<unique_ptr<PCB>> g_process_storage;
-extern thread g_scheduler_thread;
+int registerProcess(PCB* process);  // assigns process->id
+PCB* processByPid(int pid);
+PCB* findProcess(const string& name);
+int highestPid();
+extern vector<unique_ptr<CoreRunQueue>> g_core_run_queues;
 extern vector<thread> g_worker_threads;
 extern atomic<bool> g_threads_started;
 extern const int TICK_DURATION_MS;
+extern bool g_virtual_time;
+extern vector<unique_ptr<CoreTickSlot>> g_core_tick_slots;
+extern thread_local int t_core_id;  // -1 off the worker threads
 extern atomic<unsigned long long> g_cpu_ticks;
 extern atomic<long long> g_idle_cpu_ticks;
 extern atomic<long long> g_active_cpu_ticks;
+extern atomic<long long> g_generation_skipped;
+extern atomic<unsigned long long> g_dispatch_events;
 extern atomic<long long> g_pages_paged_in;
 extern atomic<long long> g_pages_paged_out;
-extern mutex g_tick_mutex;
-extern condition_variable g_tick_cv;
 extern thread g_tick_thread;
 extern mutex outputMutex;
 extern map<string, Console> screens;
-extern unordered_map<string, uint16_t> variables;
-extern random_device rd;
-extern mt19937 gen;
-extern uniform_int_distribution<uint16_t> dist;
 extern bool enable_sleep;
 extern bool enable_for;
 extern atomic<bool> g_keep_generating;
@@ -114,67 +546,210 @@ extern int config_batch_process_freq;
 extern int config_min_ins;
 extern int config_max_ins;
 extern int config_delay_per_exec;
+extern uint64_t config_random_seed;
 extern SchedulerType current_scheduler_type;
 
 // memory management
-struct MemoryBlock {
-    int start_address;
-    int size;
-    bool is_free;
-    string process_name;
-};
+enum MemoryAllocatorType { ALLOC_FIRST_FIT, ALLOC_BEST_FIT, ALLOC_NEXT_FIT, ALLOC_BUDDY };
 
-struct Page {
-    int page_number;
-    string process_name;
-    bool is_in_memory;
-    int frame_number;
-    time_t last_access_time;
+// Allocator for the contiguous process memory space, driven by memory.cpp
+// under g_memory_mutex.
+class MemoryAllocator {
+public:
+    virtual ~MemoryAllocator() = default;
+    virtual const char* name() const = 0;
+    virtual void reset(int total_bytes) = 0;
+    virtual bool allocate(int size, MemoryExtent& block) = 0;  // block may be larger than size
+    virtual void release(const MemoryExtent& block) = 0;
+    virtual bool reserve(const MemoryExtent& block) = 0;  // claim exactly this free range, for compaction
+    virtual int totalBytes() const = 0;  // bytes it can hand out
+    virtual int freeBytes() const = 0;
+    virtual int largestFreeExtent() const = 0;
+    virtual vector<MemoryExtent> freeExtents() const = 0;  // in address order
 };
 
-extern vector<MemoryBlock> g_memory_blocks;
-extern mutex g_memory_mutex;
+unique_ptr<MemoryAllocator> makeMemoryAllocator(MemoryAllocatorType type);
+
+extern ProfiledMutex g_memory_mutex;
+extern MemoryAllocatorType config_memory_allocator;
+extern int config_compaction_threshold;  // external fragmentation percent that starts compaction
+extern int config_compaction_stop_threshold;  // and the percent that ends it
+extern atomic<long long> g_compaction_moves;
+extern atomic<long long> g_compaction_bytes_moved;
 extern int g_max_overall_mem;
 extern int g_mem_per_frame;
 extern int g_min_mem_per_proc;
 extern int g_max_mem_per_proc;
-extern vector<Page> g_page_table;
-extern vector<bool> g_frame_table;
+// Backing-store log record. Paging code only queues these; a writer thread
+// turns them into text lines or dumps them raw to the backing-store file.
+enum PagingEventType : uint32_t { PAGE_IN_EVENT, PAGE_OUT_EVENT };
+
+struct PagingEvent {
+    PagingEventType type;
+    int32_t pid;
+    int32_t page_number;
+    int32_t frame_number;
+    char process_name[16];  // NUL-terminated, truncated if longer
+};
+
+enum BackingStoreFormat { BACKING_STORE_TEXT, BACKING_STORE_BINARY };
+
+enum PageReplacementType { REPLACE_LRU, REPLACE_FIFO, REPLACE_CLOCK, REPLACE_ARC };
+
+// Page replacement policy, driven by the pager under g_paging_mutex. A key
+// identifies a process page across evictions (ARC remembers evicted ones).
+class ReplacementPolicy {
+public:
+    virtual ~ReplacementPolicy() = default;
+    virtual const char* name() const = 0;
+    virtual void reset(int total_frames) = 0;
+    virtual void onMiss(uint64_t) {}                   // fault on key, before any victim is chosen
+    virtual void onLoad(int frame, uint64_t key) = 0;  // page faulted into frame
+    virtual void onAccess(int frame) = 0;              // hit on a resident page
+    virtual void onRemove(int frame, uint64_t key, bool evicted) = 0;  // evicted, or freed with its process
+    virtual int chooseVictim(uint64_t incoming_key) = 0;  // frame to evict, -1 if none
+};
+
+unique_ptr<ReplacementPolicy> makeReplacementPolicy(PageReplacementType type);
+
+// Per-core software TLB: a direct-mapped cache of (pid, page) -> frame that
+// its core reads and fills without a lock. Entries are tagged with the pid,
+// so a context switch needs no flush. Other cores only post shootdowns: a key
+// in the ring, then a bump of shootdown_generation (memory.cpp). Queued stores
+// carry their own copy of the bytes, and a core evicting a page writes any
+// store still queued for it into the frame first, under store_mutex.
+struct SoftwareTlb {
+    static const int INDEX_BITS = 6;
+    static const int ENTRIES = 1 << INDEX_BITS;
+    static const int SHOOTDOWN_RING = 64;  // behind by more than this: flush all
+    static const int TOUCH_BATCH = 64;     // hits queued for the policy
+    static const int STORE_BATCH = 32;     // stores queued for their frames
+    static const int MAX_STORE_BYTES = 64; // a whole symbol table
+
+    struct Entry {
+        uint64_t key = 0;  // pid << 32 | page, 0 when empty
+        int frame_number = -1;
+    };
+    struct PendingTouch {
+        uint64_t key;
+        int frame_number;
+    };
+    struct PendingStore {
+        uint64_t key;  // 0 once written by an evicting core
+        int frame_number;
+        uint16_t offset;
+        uint16_t length;
+        char bytes[MAX_STORE_BYTES];
+    };
+
+    // Owner only
+    Entry entries[ENTRIES];
+    PendingTouch pending[TOUCH_BATCH];
+    int pending_count = 0;
+    uint64_t seen_generation = 0;
+
+    // Appended by the owner, drained by it or by a core evicting one of the pages
+    mutex store_mutex;
+    PendingStore stores[STORE_BATCH];
+    int store_count = 0;
+
+    // Written by the owner, read by vmstat
+    atomic<long long> hits{0};
+    atomic<long long> misses{0};
+
+    // Written under g_paging_mutex by whoever frees a frame
+    alignas(64) atomic<uint64_t> shootdown_generation{0};
+    atomic<uint64_t> shootdown_keys[SHOOTDOWN_RING] = {};
+};
+
+extern vector<FrameEntry> g_frame_table;
+extern vector<unique_ptr<SoftwareTlb>> g_core_tlbs;
 extern ofstream g_backing_store;
-extern mutex g_paging_mutex;
+extern ProfiledMutex g_paging_mutex;
+extern MPMCQueue<PagingEvent> g_backing_store_events;
+extern vector<char> g_physical_memory;
+extern atomic<long long> g_swap_bytes_written;
+extern atomic<long long> g_swap_bytes_read;
+extern BackingStoreFormat config_backing_store_format;
+extern PageReplacementType config_page_replacement;
+enum AccessPattern { ACCESS_SEQUENTIAL, ACCESS_UNIFORM, ACCESS_ZIPF, ACCESS_PHASED };
+extern AccessPattern config_access_pattern;
+extern int config_pages_per_instruction;
+// Pages one instruction touches at most. A core only takes its fast path while
+// this many more touches still fit in its batch.
+const int MAX_PAGES_PER_INSTRUCTION = 16;
+extern atomic<long long> g_page_hits;    // instruction accesses that found the page resident
+extern atomic<long long> g_page_faults;  // instruction accesses that had to page in
+extern atomic<long long> g_instructions_executed;
+extern atomic<long long> g_replacement_policy_ns;  // time spent inside the policy
 
 void initializeMemory();
-bool allocateMemoryFirstFit(PCB* process);
+void stopCompactor();
+void compactOnTick();  // virtual time: one compaction slice between ticks
+bool allocateMemory(PCB* process);
+int usedMemoryBytes();
+
+// Wasted memory, for comparing allocators: internal is the bytes blocks
+// hold beyond what their processes asked for, external the free memory not
+// in the largest free block
+struct FragmentationStats {
+    int requested_bytes;
+    int used_bytes;
+    int free_bytes;
+    int largest_free_bytes;
+};
+FragmentationStats memoryFragmentation();
+const char* memoryAllocatorName();
 void deallocateMemory(PCB* process);
 int calculatePagesRequired(int memorySize);
 void printMemoryState(const char* context);
+int auditMemory(const char* context);  // full check; returns violations found
+extern int config_audit_interval;      // checked builds audit every Nth allocate/free
+extern atomic<long long> g_audit_violations;
 
 // Paging functions
 void initializePaging();
-void pageIn(const string& process_name, int page_number);
-void pageOut(const string& process_name, int page_number);
-int findLRUPage();
-bool isProcessInMemory(const string& process_name);
-void simulateMemoryAccess(const string& process_name);
+void pageIn(PCB* process, int page_number);
+void pageOut(PCB* process, int page_number);
+const char* replacementPolicyName();
+int freeFrameCount();
+void initializeTlbs(int cores);
+void resetReplacementPolicy();
+void tlbStats(long long& hits, long long& misses);
+bool isProcessInMemory(PCB* process);
+void simulateMemoryAccess(PCB* process);  // one instruction's worth of page touches
+int nextAccessPage(PCB* process);
+const char* accessPatternName();
 void closePagingSystem();
+void stopBackingStoreWriter();
+void closeSwapDevice();
+void storeProcessBytes(PCB* process, int address, const void* data, int size);
+void flushPendingTouches();  // before a process can move to another core, or the core idles
 
 // Instruction execution
-void DECLARE(const string& var, uint16_t value);
-uint16_t getValue(const string& varOrValue);
-void ADD(const string& var1, const string& op2, const string& op3);
-void SUBTRACT(const string& var1, const string& op2, const string& op3);
-double setVariableDefault();
-string randomVariable();
-string randomUint16Value();
-string randomVarOrValue();
-void PRINT(const string& msg, PCB* current_process = nullptr, 
+void DECLARE(RegisterFile& regs, uint16_t slot, uint16_t value);
+uint16_t getValue(const Program& program, const RegisterFile& regs, const string& varOrValue);
+void ADD(RegisterFile& regs, uint16_t slot, uint16_t val2, uint16_t val3);
+void SUBTRACT(RegisterFile& regs, uint16_t slot, uint16_t val2, uint16_t val3);
+double setVariableDefault(RegisterFile& regs);
+string randomVariable(Xoshiro256& rng);
+string randomUint16Value(Xoshiro256& rng);
+string randomVarOrValue(Xoshiro256& rng);
+void PRINT(const string& msg, const vector<string>& names, PCB* current_process = nullptr,
           const string& process_name = "", const string& screen_name = "");
+void PRINT(const Program& program, uint16_t index, PCB* current_process);
+void appendProcessLog(PCB* process, const string& record);
+bool printProcessLogs(PCB* process);
 void SLEEP(uint8_t ticks);
-void FOR(const vector<string>& instructions, int repeats, int nestingLevel, PCB* current_process);
+void FOR(const Program& program, size_t body_begin, size_t body_end, int repeats, int nestingLevel, PCB* current_process);
+Program compileProgram(const vector<string>& instructions, RegisterFile& regs, vector<string> names = {});
+void runProgram(const Program& program, size_t begin, size_t end, int nestingLevel, PCB* current_process);
 void executeInstructionSet(const vector<string>& instructions, int nestingLevel, PCB* current_process);
-vector<string> generateRandomInstructions(const string& processName, int count, 
+vector<string> generateRandomInstructions(Xoshiro256& rng, const string& processName, int count, 
                                         bool enable_sleep, bool enable_for);
-void printVarValues();
+void generateProgramChunk(PCB* process, int chunk);
+void executeProgramStep(PCB* process, int index);
+void printVarValues(const Program& program, const RegisterFile& regs);
 
 // Console class
 class Console {
@@ -2,74 +2,160 @@
 
 mutex outputMutex;
 map<string, Console> screens;
-unordered_map<string, uint16_t> variables;
-random_device rd;
-mt19937 gen(rd());
-uniform_int_distribution<uint16_t> dist(0, 65535);
 bool enable_sleep = false;
 bool enable_for = false;
 
-void DECLARE(const string& var, uint16_t value) {
-    variables[var] = value;
-}
-
-uint16_t getValue(const string& varOrValue) {
-    if (variables.count(varOrValue)) return variables[varOrValue];
+// Value a name reads as before anything is written to it: the old
+// interpreter fell back to stoi on the operand text, or 0.
+static uint16_t parseUint16(const string& text) {
     try {
-        return static_cast<uint16_t>(stoi(varOrValue));
+        return static_cast<uint16_t>(stoi(text));
     } catch (const exception&) {
-        return 0; 
+        return 0;
+    }
+}
+
+int Program::findVariable(const string& name) const {
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (names[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// A new slot starts out unwritten, reading as its name's number
+int Program::bindVariable(const string& name, RegisterFile& regs) {
+    int slot = findVariable(name);
+    if (slot != -1 || names.size() == RegisterFile::MAX_REGISTERS) return slot;
+    slot = static_cast<int>(names.size());
+    names.push_back(name);
+    regs.values[slot] = parseUint16(name);
+    regs.defined &= ~(1u << slot);
+    return slot;
+}
+
+const vector<string>& seededVariableNames() {
+    static const vector<string> names = {"var1", "var2", "var3"};
+    return names;
+}
+
+void RegisterFile::reset() {
+    defined = 0;
+    for (int slot = 0; slot < static_cast<int>(seededVariableNames().size()); ++slot) {
+        DECLARE(*this, static_cast<uint16_t>(slot), 0);
     }
 }
 
-void ADD(const string& var1, const string& op2, const string& op3) {
-    if (!variables.count(var1)) variables[var1] = 0;
-    uint16_t val2 = getValue(op2);
-    uint16_t val3 = getValue(op3);
+// Writes to a variable that could not get a slot are dropped
+void DECLARE(RegisterFile& regs, uint16_t slot, uint16_t value) {
+    if (slot == NO_SLOT) return;
+    regs.values[slot] = value;
+    regs.defined |= 1u << slot;
+}
+
+uint16_t getValue(const Program& program, const RegisterFile& regs, const string& varOrValue) {
+    int slot = program.findVariable(varOrValue);
+    if (slot != -1) return regs.values[slot];
+    return parseUint16(varOrValue);
+}
+
+void ADD(RegisterFile& regs, uint16_t slot, uint16_t val2, uint16_t val3) {
     uint32_t sum = static_cast<uint32_t>(val2) + static_cast<uint32_t>(val3);
     if (sum > 65535) sum = 65535;
-    variables[var1] = static_cast<uint16_t>(sum);
+    DECLARE(regs, slot, static_cast<uint16_t>(sum));
 }
 
-void SUBTRACT(const string& var1, const string& op2, const string& op3) {
-    if (!variables.count(var1)) variables[var1] = 0;
-    uint16_t val2 = getValue(op2);
-    uint16_t val3 = getValue(op3);
+void SUBTRACT(RegisterFile& regs, uint16_t slot, uint16_t val2, uint16_t val3) {
     int32_t diff = static_cast<int32_t>(val2) - static_cast<int32_t>(val3);
     if (diff < 0) diff = 0;
-    variables[var1] = static_cast<uint16_t>(diff);
+    DECLARE(regs, slot, static_cast<uint16_t>(diff));
 }
 
-double setVariableDefault() {
-    for (auto& kv : variables) kv.second = 0;
+double setVariableDefault(RegisterFile& regs) {
+    for (auto& value : regs.values) value = 0;
     return 0;
 }
 
-string randomVariable() {
-    static const vector<string> vars = {"var1", "var2", "var3"};
-    uniform_int_distribution<int> pick(0, 2);
-    return vars[pick(gen)];
+string randomVariable(Xoshiro256& rng) {
+    static const string vars[] = {"var1", "var2", "var3"};
+    return vars[rng.below(3)];
 }
 
-string randomUint16Value() {
-    return to_string(dist(gen));
+string randomUint16Value(Xoshiro256& rng) {
+    return to_string(static_cast<uint16_t>(rng() >> 48));
+}
+
+string randomVarOrValue(Xoshiro256& rng) {
+    if (rng.below(2)) return randomVariable(rng);
+    return randomUint16Value(rng);
+}
+
+// Write the buffered records to the process's output file and empty the
+// buffer. The first spill truncates whatever a previous run left there.
+static void spillProcessLogs(PCB* process) {
+    LogBuffer& logs = process->logs;
+    ofstream out(process->output_filename, logs.spilled == 0 ? ios::trunc : ios::app);
+    for (int i = 0; i < logs.count; ++i) {
+        out << logs.records[i] << '\n';
+    }
+    if (out) {
+        logs.spilled += logs.count;
+    } else {
+        lock_guard<mutex> lock(outputMutex);
+        cerr << "Could not write log of " << process->name << " to "
+             << process->output_filename << "; dropping " << logs.count << " records" << endl;
+    }
+    logs.count = 0;
+}
+
+void appendProcessLog(PCB* process, const string& record) {
+    LogBuffer& logs = process->logs;
+    lock_guard<mutex> lock(logs.buffer_mutex);
+    if (logs.count == LOG_BUFFER_CAPACITY) spillProcessLogs(process);
+    logs.records[logs.count++].assign(record);  // reuses the slot's storage
+}
+
+// Print a process's whole log: the spilled part streamed from its output
+// file, then what is still buffered. Returns false if it has no output.
+bool printProcessLogs(PCB* process) {
+    LogBuffer& logs = process->logs;
+    lock_guard<mutex> lock(logs.buffer_mutex);
+    if (logs.spilled > 0) {
+        ifstream in(process->output_filename);
+        string line;
+        while (getline(in, line)) {
+            cout << line << '\n';
+        }
+    }
+    for (int i = 0; i < logs.count; ++i) {
+        cout << logs.records[i] << '\n';
+    }
+    cout << flush;
+    return logs.spilled > 0 || logs.count > 0;
 }
 
-string randomVarOrValue() {
-    if (dist(gen) % 2) return randomVariable();
-    return randomUint16Value();
+// PRINT output goes to the process log, or to the console when run without one
+static void emitOutput(const string& output, PCB* current_process) {
+    if (current_process) {
+        appendProcessLog(current_process, output);
+    } else {
+        lock_guard<mutex> lock(outputMutex);
+        cout << output << endl;
+    }
 }
 
-void PRINT(const string& msg, PCB* current_process, const string& process_name, const string& screen_name) {
+void PRINT(const string& msg, const vector<string>& names, PCB* current_process, const string& process_name,
+           const string& screen_name) {
     string output = msg;
     
     if (msg.empty() && !process_name.empty()) {
         output = "Hello world from " + process_name + "!";
     }
     
-    for (const auto& var : variables) {
-        string varName = var.first;
-        string varValue = to_string(var.second);
+    int var_count = current_process ? static_cast<int>(names.size()) : 0;
+    for (int i = 0; i < var_count; ++i) {
+        if (!(current_process->registers.defined & (1u << i))) continue;
+        const string& varName = names[i];
+        string varValue = to_string(current_process->registers.values[i]);
         
         size_t pos = 0;
         while ((pos = output.find(varName, pos)) != string::npos) {
@@ -91,151 +177,349 @@ void PRINT(const string& msg, PCB* current_process, const string& process_name,
         }
     }
     
-    if (current_process) {
-        lock_guard<mutex> lock(outputMutex);
-        current_process->logs.push_back(output);
-    } else {
-        lock_guard<mutex> lock(outputMutex);
-        cout << output << endl;
+    emitOutput(output, current_process);
+}
+
+// Render a precompiled PRINT template into a per-core buffer. Produces the
+// same bytes as the substitution above without scanning the message once per
+// variable or reallocating on every print.
+void PRINT(const Program& program, uint16_t index, PCB* current_process) {
+    if (!current_process || program.legacy_print) {
+        PRINT(program.strings[index], program.names, current_process);
+        return;
     }
+
+    static thread_local string buffer;
+    buffer.clear();
+
+    const string& msg = program.strings[index];
+    const RegisterFile& regs = current_process->registers;
+    for (uint32_t i = program.template_begin[index]; i < program.template_begin[index + 1]; ++i) {
+        const PrintSegment& segment = program.segments[i];
+        if (segment.slot != NO_SLOT && (regs.defined & (1u << segment.slot))) {
+            char digits[8];
+            auto result = to_chars(digits, digits + sizeof(digits), regs.values[segment.slot]);
+            buffer.append(digits, result.ptr);
+        } else {
+            buffer.append(msg, segment.offset, segment.length);
+        }
+    }
+    emitOutput(buffer, current_process);
 }
 
 void SLEEP(uint8_t ticks) {
     if (ticks == 0) return;
-    this_thread::sleep_for(chrono::milliseconds(config_delay_per_exec * ticks));
+    waitUntilTick(g_cpu_ticks.load() + ticks);
 }
 
-void FOR(const vector<string>& instructions, int repeats, int nestingLevel, PCB* current_process) {
+void FOR(const Program& program, size_t body_begin, size_t body_end, int repeats, int nestingLevel, PCB* current_process) {
     if (nestingLevel >= 3) {
         lock_guard<mutex> lock(outputMutex);
         cout << "Maximum nesting level (3) reached. Skipping nested FOR loop." << endl;
         return;
     }
 
-    if (repeats < 0) repeats = 0;
-    if (repeats > 100) repeats = 100; 
-    
     for (int i = 0; i < repeats; ++i) {
-        executeInstructionSet(instructions, nestingLevel + 1, current_process);
+        runProgram(program, body_begin, body_end, nestingLevel + 1, current_process);
         if (g_exit_flag) break;
     }
 }
 
-void executeInstructionSet(const vector<string>& instructions, int nestingLevel, PCB* current_process) {
-    for (const string& instruction : instructions) {
-        if (g_exit_flag) break; 
-        
-        istringstream iss(instruction);
-        string command;
-        iss >> command;
-        
-        if (command == "DECLARE") {
-            string var;
-            string valueStr;
-            if (iss >> var >> valueStr) {
-                try {
-                    uint16_t value = static_cast<uint16_t>(stoi(valueStr));
-                    DECLARE(var, value);
-                } catch (const exception&) {
-                    DECLARE(var, 0);
-                }
+// ---- Front end: instruction text -> packed bytecode ----
+
+static string trimmed(const string& text) {
+    size_t first = text.find_first_not_of(" \t");
+    if (first == string::npos) return "";
+    size_t last = text.find_last_not_of(" \t");
+    return text.substr(first, last - first + 1);
+}
+
+// An integer operand compiled as an immediate. The string interpreter looked
+// a token up as a variable before parsing it as a number, so if the program
+// binds a variable of that name anywhere (ADD 5 5 5), the operand is turned
+// back into a read of that register once the whole program is compiled.
+struct FoldedLiteral {
+    size_t code_index;
+    uint8_t imm_flag;
+    string name;
+};
+
+// A token that is entirely an integer literal becomes an immediate unless a
+// variable already has that name; anything else names a register. If no
+// register is left, the operand is folded to the value the name would have
+// read as anyway.
+static uint16_t compileOperand(const string& token, Program& program, RegisterFile& regs,
+                               uint8_t imm_flag, uint8_t& flags, vector<FoldedLiteral>& folded) {
+    if (program.findVariable(token) == -1) {
+        try {
+            size_t used = 0;
+            int value = stoi(token, &used);
+            if (used == token.size()) {
+                flags |= imm_flag;
+                folded.push_back({program.code.size(), imm_flag, token});
+                return static_cast<uint16_t>(value);
             }
+        } catch (const exception&) {
         }
-        else if (command == "ADD") {
-            string var1, op2, op3;
-            if (iss >> var1 >> op2 >> op3) {
-                ADD(var1, op2, op3);
+    }
+    int slot = program.bindVariable(token, regs);
+    if (slot == -1) {
+        flags |= imm_flag;
+        return parseUint16(token);
+    }
+    return static_cast<uint16_t>(slot);
+}
+
+static uint16_t compileTarget(const string& name, Program& program, RegisterFile& regs) {
+    int slot = program.bindVariable(name, regs);
+    return slot == -1 ? NO_SLOT : static_cast<uint16_t>(slot);
+}
+
+// Append one statement to the program. Malformed statements compile to
+// nothing, exactly as the string interpreter used to skip them.
+static void compileStatement(const string& statement, Program& program, RegisterFile& regs,
+                             vector<FoldedLiteral>& folded) {
+    istringstream iss(statement);
+    string command;
+    iss >> command;
+
+    Instruction ins = {};
+    if (command == "DECLARE") {
+        string var, valueStr;
+        if (!(iss >> var >> valueStr)) return;
+        ins.op = OP_DECLARE;
+        ins.a = compileTarget(var, program, regs);
+        ins.b = parseUint16(valueStr);
+        program.code.push_back(ins);
+    }
+    else if (command == "ADD" || command == "SUBTRACT") {
+        string var1, op2, op3;
+        if (!(iss >> var1 >> op2 >> op3)) return;
+        ins.op = command == "ADD" ? OP_ADD : OP_SUBTRACT;
+        ins.a = compileTarget(var1, program, regs);
+        ins.b = compileOperand(op2, program, regs, IMM_B, ins.flags, folded);
+        ins.c = compileOperand(op3, program, regs, IMM_C, ins.flags, folded);
+        program.code.push_back(ins);
+    }
+    else if (command == "PRINT") {
+        string msg;
+        getline(iss, msg);
+        if (!msg.empty()) {
+            msg.erase(0, msg.find_first_not_of(" \t"));
+            if (msg.length() >= 2 && msg.front() == '"' && msg.back() == '"') {
+                msg = msg.substr(1, msg.length() - 2);
             }
         }
-        else if (command == "SUBTRACT") {
-            string var1, op2, op3;
-            if (iss >> var1 >> op2 >> op3) {
-                SUBTRACT(var1, op2, op3);
-            }
+        // Generated programs repeat a handful of messages, so share them
+        auto existing = find(program.strings.begin(), program.strings.end(), msg);
+        ins.op = OP_PRINT;
+        ins.a = static_cast<uint16_t>(existing - program.strings.begin());
+        if (existing == program.strings.end()) {
+            program.strings.push_back(msg);
         }
-        else if (command == "PRINT") {
-            string msg;
-            getline(iss, msg);
-
-            if (!msg.empty()) {
-                msg.erase(0, msg.find_first_not_of(" \t"));
-                if (msg.length() >= 2 && msg.front() == '"' && msg.back() == '"') {
-                    msg = msg.substr(1, msg.length() - 2);
-                }
-            }
-            PRINT(msg, current_process);
+        program.code.push_back(ins);
+    }
+    else if (command == "SLEEP") {
+        string ticksStr;
+        if (!(iss >> ticksStr)) return;
+        try {
+            ins.b = static_cast<uint8_t>(stoi(ticksStr));
+        } catch (const exception&) {
+            return;
         }
-        else if (command == "SLEEP") {
-            string ticksStr;
-            if (iss >> ticksStr) {
-                try {
-                    uint8_t ticks = static_cast<uint8_t>(stoi(ticksStr));
-                    SLEEP(ticks);
-                } catch (const exception&) {
-                    // Skip invalid SLEEP commands
-                }
+        ins.op = OP_SLEEP;
+        program.code.push_back(ins);
+    }
+    else if (command == "FOR") {
+        string line;
+        getline(iss, line);
+        size_t lastSpace = line.find_last_of(' ');
+        if (lastSpace == string::npos) return;
+
+        int repeats = 0;
+        try {
+            repeats = stoi(line.substr(lastSpace + 1));
+        } catch (const exception&) {
+            repeats = 0;
+        }
+        if (repeats < 0) repeats = 0;
+        if (repeats > 100) repeats = 100;
+
+        // The body follows the FOR inline; a holds its length once known
+        size_t for_index = program.code.size();
+        ins.op = OP_FOR;
+        ins.b = static_cast<uint16_t>(repeats);
+        program.code.push_back(ins);
+
+        istringstream bodyStream(trimmed(line.substr(0, lastSpace)));
+        string bodyStatement;
+        while (getline(bodyStream, bodyStatement, ',')) {
+            bodyStatement = trimmed(bodyStatement);
+            if (!bodyStatement.empty()) {
+                compileStatement(bodyStatement, program, regs, folded);
             }
         }
-        else if (command == "FOR") {
-            string line;
-            getline(iss, line);
-            
-            size_t lastSpace = line.find_last_of(' ');
-            if (lastSpace != string::npos) {
-                string instructionsStr = line.substr(0, lastSpace);
-                string repeatsStr = line.substr(lastSpace + 1);
-                
-                instructionsStr.erase(0, instructionsStr.find_first_not_of(" \t"));
-                instructionsStr.erase(instructionsStr.find_last_not_of(" \t") + 1);
-                
-                int repeats = 0;
-                try {
-                    repeats = stoi(repeatsStr);
-                } catch (const exception&) {
-                    repeats = 0;
-                }
-                
-                vector<string> forInstructions;
-                istringstream instrStream(instructionsStr);
-                string singleInstr;
-                
-                while (getline(instrStream, singleInstr, ',')) {
-                    singleInstr.erase(0, singleInstr.find_first_not_of(" \t"));
-                    singleInstr.erase(singleInstr.find_last_not_of(" \t") + 1);
-                    if (!singleInstr.empty()) {
-                        forInstructions.push_back(singleInstr);
-                    }
+        program.code[for_index].a = static_cast<uint16_t>(program.code.size() - for_index - 1);
+    }
+}
+
+static bool isWordChar(char c) {
+    return isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// Split every PRINT message into literal runs and references to bound
+// variables. A reference is a maximal run of word characters equal to a
+// variable name, which is exactly what the whole-word check in PRINT accepts.
+// That equivalence breaks if a name contains non-word characters or is all
+// digits (it could then match inside another variable's value), so such
+// programs keep the substituting PRINT.
+static void buildPrintTemplates(Program& program) {
+    program.legacy_print = false;
+    for (const string& name : program.names) {
+        bool all_digits = true;
+        for (char c : name) {
+            if (!isWordChar(c)) program.legacy_print = true;
+            if (!isdigit(static_cast<unsigned char>(c))) all_digits = false;
+        }
+        if (all_digits) program.legacy_print = true;
+    }
+
+    program.segments.clear();
+    program.template_begin.assign(1, 0);
+    for (const string& msg : program.strings) {
+        size_t literal_start = 0;
+        size_t pos = 0;
+        while (pos < msg.size()) {
+            if (!isWordChar(msg[pos])) {
+                ++pos;
+                continue;
+            }
+            size_t word_end = pos;
+            while (word_end < msg.size() && isWordChar(msg[word_end])) ++word_end;
+
+            int slot = program.findVariable(msg.substr(pos, word_end - pos));
+            if (slot != -1) {
+                if (pos > literal_start) {
+                    program.segments.push_back({static_cast<uint32_t>(literal_start),
+                                                static_cast<uint32_t>(pos - literal_start), NO_SLOT});
                 }
-                
-                FOR(forInstructions, repeats, nestingLevel, current_process);
+                program.segments.push_back({static_cast<uint32_t>(pos),
+                                            static_cast<uint32_t>(word_end - pos), static_cast<uint16_t>(slot)});
+                literal_start = word_end;
             }
+            pos = word_end;
         }
+        if (msg.size() > literal_start) {
+            program.segments.push_back({static_cast<uint32_t>(literal_start),
+                                        static_cast<uint32_t>(msg.size() - literal_start), NO_SLOT});
+        }
+        program.template_begin.push_back(static_cast<uint32_t>(program.segments.size()));
     }
 }
 
-vector<string> generateRandomInstructions(const string& processName, int count, bool enable_sleep, bool enable_for) {
+// names is the symbol table to start from: what earlier chunks of the same
+// program bound, which regs already holds values for
+Program compileProgram(const vector<string>& instructions, RegisterFile& regs, vector<string> names) {
+    Program program;
+    program.names = move(names);
+    program.code.reserve(instructions.size());
+    program.statements.reserve(instructions.size());
+    vector<FoldedLiteral> folded;
+    for (const string& instruction : instructions) {
+        program.statements.push_back(static_cast<uint32_t>(program.code.size()));
+        compileStatement(instruction, program, regs, folded);
+    }
+    // A register reads as its name's number until written, so the swap only
+    // matters once the variable is assigned
+    for (const FoldedLiteral& literal : folded) {
+        int slot = program.findVariable(literal.name);
+        if (slot == -1) continue;
+        Instruction& ins = program.code[literal.code_index];
+        ins.flags &= ~literal.imm_flag;
+        (literal.imm_flag == IMM_B ? ins.b : ins.c) = static_cast<uint16_t>(slot);
+    }
+    // Templates need every name the program binds, including ones declared
+    // after the PRINT (a FOR body can print a variable it declares later)
+    buildPrintTemplates(program);
+    return program;
+}
+
+// ---- Interpreter ----
+
+// Instructions run without a process get a throwaway register file
+static RegisterFile& registersFor(PCB* current_process) {
+    static thread_local RegisterFile scratch_registers;
+    return current_process ? current_process->registers : scratch_registers;
+}
+
+void runProgram(const Program& program, size_t begin, size_t end, int nestingLevel, PCB* current_process) {
+    RegisterFile& regs = registersFor(current_process);
+
+    const Instruction* code = program.code.data();
+    size_t pc = begin;
+    while (pc < end) {
+        if (g_exit_flag) break;
+
+        const Instruction& ins = code[pc++];
+        switch (ins.op) {
+            case OP_DECLARE:
+                DECLARE(regs, ins.a, ins.b);
+                break;
+            // ADD/SUBTRACT create their target as 0 before reading operands
+            case OP_ADD:
+                if (ins.a != NO_SLOT && !(regs.defined & (1u << ins.a))) DECLARE(regs, ins.a, 0);
+                ADD(regs, ins.a,
+                    (ins.flags & IMM_B) ? ins.b : regs.values[ins.b],
+                    (ins.flags & IMM_C) ? ins.c : regs.values[ins.c]);
+                break;
+            case OP_SUBTRACT:
+                if (ins.a != NO_SLOT && !(regs.defined & (1u << ins.a))) DECLARE(regs, ins.a, 0);
+                SUBTRACT(regs, ins.a,
+                         (ins.flags & IMM_B) ? ins.b : regs.values[ins.b],
+                         (ins.flags & IMM_C) ? ins.c : regs.values[ins.c]);
+                break;
+            case OP_PRINT:
+                PRINT(program, ins.a, current_process);
+                break;
+            case OP_SLEEP:
+                SLEEP(static_cast<uint8_t>(ins.b));
+                break;
+            case OP_FOR:
+                FOR(program, pc, pc + ins.a, ins.b, nestingLevel, current_process);
+                pc += ins.a;
+                break;
+        }
+    }
+}
+
+void executeInstructionSet(const vector<string>& instructions, int nestingLevel, PCB* current_process) {
+    Program program = compileProgram(instructions, registersFor(current_process));
+    runProgram(program, 0, program.code.size(), nestingLevel, current_process);
+}
+
+vector<string> generateRandomInstructions(Xoshiro256& rng, const string& processName, int count, bool enable_sleep, bool enable_for) {
     vector<string> instructions;
 
     vector<int> possibleInstructions = {0, 1, 2, 3, 4};
     if (enable_sleep) possibleInstructions.push_back(5);
     if (enable_for) possibleInstructions.push_back(6);
 
-    uniform_int_distribution<int> instrType(0, possibleInstructions.size() - 1);
+    uint32_t instrTypes = static_cast<uint32_t>(possibleInstructions.size());
 
     for (int i = 0; i < count; ++i) {
-        switch (possibleInstructions[instrType(gen)]) {
+        switch (possibleInstructions[rng.below(instrTypes)]) {
             case 0:
-                instructions.push_back("DECLARE " + randomVariable() + " " + randomUint16Value());
+                instructions.push_back("DECLARE " + randomVariable(rng) + " " + randomUint16Value(rng));
                 break;
             case 1:
-                instructions.push_back("ADD " + randomVariable() + " " + randomVarOrValue() + " " + randomVarOrValue());
+                instructions.push_back("ADD " + randomVariable(rng) + " " + randomVarOrValue(rng) + " " + randomVarOrValue(rng));
                 break;
             case 2:
-                instructions.push_back("SUBTRACT " + randomVariable() + " " + randomVarOrValue() + " " + randomVarOrValue());
+                instructions.push_back("SUBTRACT " + randomVariable(rng) + " " + randomVarOrValue(rng) + " " + randomVarOrValue(rng));
                 break;
             case 3:
                 {
-                    string var = randomVariable();
+                    string var = randomVariable(rng);
                     instructions.push_back("PRINT \"Value of " + var + " is " + var + "\"");
                 }
                 break;
@@ -243,10 +527,10 @@ vector<string> generateRandomInstructions(const string& processName, int count,
                 instructions.push_back("PRINT \"Hello world from " + processName + "!\"");
                 break;
             case 5:
-                instructions.push_back("SLEEP " + to_string(rand() % 1000));
+                instructions.push_back("SLEEP " + to_string(rng.below(1000)));
                 break;
             case 6:
-                instructions.push_back("FOR " + to_string(rand() % 5 + 1));
+                instructions.push_back("FOR " + to_string(rng.below(5) + 1));
                 break;
         }
     }
@@ -254,9 +538,42 @@ vector<string> generateRandomInstructions(const string& processName, int count,
     return instructions;
 }
 
-void printVarValues() {
+// Generated programs are produced PROGRAM_CHUNK_SIZE statements at a time.
+// Chunk k is drawn from its own generator seeded with (program_seed, k), so a
+// seed always yields the same program no matter when or in what order chunks
+// are generated, and only the chunk being executed is kept in memory.
+void generateProgramChunk(PCB* process, int chunk) {
+    Xoshiro256 rng(deriveSeed(process->program_seed, static_cast<uint64_t>(chunk)));
+
+    int first = chunk * PROGRAM_CHUNK_SIZE;
+    int count = min(PROGRAM_CHUNK_SIZE, process->instructions_total - first);
+    vector<string> source = generateRandomInstructions(
+        rng, process->name, count, enable_sleep, enable_for);
+
+    // The register file outlives each chunk, and so must the slot names
+    vector<string> names = process->program_chunk == -1 ? seededVariableNames() : process->program.names;
+    process->program = compileProgram(source, process->registers, move(names));
+    process->program_chunk = chunk;
+}
+
+void executeProgramStep(PCB* process, int index) {
+    int chunk = index / PROGRAM_CHUNK_SIZE;
+    if (process->program_chunk != chunk) {
+        generateProgramChunk(process, chunk);
+    }
+
+    const Program& program = process->program;
+    size_t statement = index % PROGRAM_CHUNK_SIZE;
+    if (statement >= program.statements.size()) return;
+    size_t begin = program.statements[statement];
+    size_t end = statement + 1 < program.statements.size() ? program.statements[statement + 1]
+                                                             : program.code.size();
+    runProgram(program, begin, end, 0, process);
+}
+
+void printVarValues(const Program& program, const RegisterFile& regs) {
     cout << "Values of\n";
-    cout << "var1 = " << variables["var1"] << endl;
-    cout << "var2 = " << variables["var2"] << endl;
-    cout << "var3 = " << variables["var3"] << endl;
+    cout << "var1 = " << getValue(program, regs, "var1") << endl;
+    cout << "var2 = " << getValue(program, regs, "var2") << endl;
+    cout << "var3 = " << getValue(program, regs, "var3") << endl;
 }
\ No newline at end of file
@@ -1,7 +1,19 @@
 #include "headers.h"
 
-int main() {
-    srand(time(0)); // Seed random number generator
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--virtual-time") {
+            g_virtual_time = true;
+        }
+    }
     menuSession();
+
+    // The pager must outlive every thread that can still fault a page in
+    if (g_threads_started) {
+        stopAndResetScheduler();
+    }
+    stopCompactor();
+    stopBackingStoreWriter();
+    closeSwapDevice();
     return 0;
 }
\ No newline at end of file
@@ -1,50 +1,666 @@
 // memory.cpp
+// Platform headers come before headers.h: windows.h does not survive a
+// preceding `using namespace std` under C++17 (std::byte vs byte).
+#ifdef _WIN64
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include "headers.h"
 #include <filesystem>
+#include <cstring>
 
-vector<MemoryBlock> g_memory_blocks;
-mutex g_memory_mutex;
-vector<Page> g_page_table;
-vector<bool> g_frame_table;
+ProfiledMutex g_memory_mutex("memory");
+MemoryAllocatorType config_memory_allocator = ALLOC_FIRST_FIT;
+static unique_ptr<MemoryAllocator> g_memory_allocator;  // guarded by g_memory_mutex
+static int g_used_memory = 0;                           // bytes held by processes
+static int g_requested_memory = 0;                      // bytes they asked for
+static map<int, PCB*> g_block_owners;                    // block start -> process holding it
+vector<FrameEntry> g_frame_table;
 ofstream g_backing_store;
-mutex g_paging_mutex;
+ProfiledMutex g_paging_mutex("paging");
 
+const size_t BACKING_STORE_QUEUE_CAPACITY = 16384;
+const size_t BACKING_STORE_BATCH = 512;  // records per write
+MPMCQueue<PagingEvent> g_backing_store_events(BACKING_STORE_QUEUE_CAPACITY);
+BackingStoreFormat config_backing_store_format = BACKING_STORE_TEXT;
+static thread g_backing_store_thread;
+static atomic<bool> g_backing_store_running(false);
+
+// Queue a paging event for the writer thread. Called under g_paging_mutex,
+// so it never touches the file; if the writer falls a full ring behind we
+// wait for it rather than lose records.
+static void logPagingEvent(PagingEventType type, const PCB* process, int page_number, int frame_number) {
+    if (!g_backing_store_running.load(memory_order_relaxed)) return;
+
+    PagingEvent event{type, process->id, page_number, frame_number, {}};
+    process->name.copy(event.process_name, sizeof(event.process_name) - 1);
+    while (!g_backing_store_events.tryPush(event)) {
+        this_thread::yield();
+    }
+}
+
+// Simulated physical memory (one mem-per-frame slice per frame) and the swap
+// device pages are evicted to. The swap file is mapped into our address space,
+// so moving a page is a memcpy and the OS does the actual I/O.
+vector<char> g_physical_memory;
+atomic<long long> g_swap_bytes_written(0);
+atomic<long long> g_swap_bytes_read(0);
+static char* g_swap_base = nullptr;
+static size_t g_swap_size = 0;
+static vector<int> g_free_swap_slots;  // stack of unused slot numbers
+#ifdef _WIN64
+static HANDLE g_swap_file = INVALID_HANDLE_VALUE;
+static HANDLE g_swap_mapping = nullptr;
+#else
+static int g_swap_fd = -1;
+#endif
+
+void closeSwapDevice() {
+#ifdef _WIN64
+    if (g_swap_base) UnmapViewOfFile(g_swap_base);
+    if (g_swap_mapping) CloseHandle(g_swap_mapping);
+    if (g_swap_file != INVALID_HANDLE_VALUE) CloseHandle(g_swap_file);
+    g_swap_mapping = nullptr;
+    g_swap_file = INVALID_HANDLE_VALUE;
+#else
+    if (g_swap_base) munmap(g_swap_base, g_swap_size);
+    if (g_swap_fd != -1) close(g_swap_fd);
+    g_swap_fd = -1;
+#endif
+    g_swap_base = nullptr;
+    g_swap_size = 0;
+    g_free_swap_slots.clear();
+}
+
+// Create and map a swap file of slot_count frames. Without a swap device
+// evicted dirty pages lose their contents, so failure is reported.
+static void openSwapDevice(size_t slot_count) {
+    closeSwapDevice();
+    size_t size = slot_count * g_mem_per_frame;
+    if (size == 0) return;
+
+#ifdef _WIN64
+    g_swap_file = CreateFileA("csopesy-swap.bin", GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+                              CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (g_swap_file != INVALID_HANDLE_VALUE) {
+        g_swap_mapping = CreateFileMappingA(g_swap_file, nullptr, PAGE_READWRITE,
+                                            static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                            static_cast<DWORD>(size & 0xFFFFFFFFu), nullptr);
+    }
+    if (g_swap_mapping) {
+        g_swap_base = static_cast<char*>(MapViewOfFile(g_swap_mapping, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    }
+#else
+    g_swap_fd = open("csopesy-swap.bin", O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (g_swap_fd != -1 && ftruncate(g_swap_fd, static_cast<off_t>(size)) == 0) {
+        void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, g_swap_fd, 0);
+        if (base != MAP_FAILED) g_swap_base = static_cast<char*>(base);
+    }
+#endif
+
+    if (!g_swap_base) {
+        cerr << "Warning: could not map swap file csopesy-swap.bin (" << size
+             << " bytes); evicted pages will lose their contents" << endl;
+        closeSwapDevice();
+        return;
+    }
+    g_swap_size = size;
+    g_free_swap_slots.reserve(slot_count);
+    for (size_t slot = slot_count; slot-- > 0;) {
+        g_free_swap_slots.push_back(static_cast<int>(slot));
+    }
+}
+
+static char* frameBytes(int frame_number) {
+    return g_physical_memory.data() + static_cast<size_t>(frame_number) * g_mem_per_frame;
+}
+
+static void releaseSwapSlot(Page& page) {
+    if (page.swap_slot != -1) {
+        g_free_swap_slots.push_back(page.swap_slot);
+        page.swap_slot = -1;
+    }
+}
+
+PageReplacementType config_page_replacement = REPLACE_LRU;
+atomic<long long> g_page_hits(0);
+atomic<long long> g_page_faults(0);
+atomic<long long> g_instructions_executed(0);
+atomic<long long> g_replacement_policy_ns(0);
+static unique_ptr<ReplacementPolicy> g_replacement_policy;
+
+// Accumulates the time spent in one policy call into g_replacement_policy_ns
+struct PolicyTimer {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    ~PolicyTimer() {
+        g_replacement_policy_ns += chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now() - start).count();
+    }
+};
+
+// Identity of a process page for the policy
+static uint64_t pageKey(int pid, int page_number) {
+    return (static_cast<uint64_t>(pid) << 32) | static_cast<uint32_t>(page_number);
+}
+
+static FreeFrameBitmap g_free_frames;  // guarded by g_paging_mutex
+
+// ---- Software TLBs ----
+//
+// A hit in the core's TLB takes no lock. Its policy update is queued and
+// replayed under g_paging_mutex the next time the core takes it (a miss or a
+// full queue), skipping any frame that has changed hands since. Freeing a
+// frame shoots its page down on every core: the key goes into each core's
+// ring and the generation advances, and the core drops matching entries at
+// its next access, or all of them if it fell a whole ring behind. As with a
+// real TLB before the shootdown lands, an access racing an eviction can still
+// count as a hit.
+
+vector<unique_ptr<SoftwareTlb>> g_core_tlbs;
+
+void initializeTlbs(int cores) {
+    g_core_tlbs.clear();
+    for (int i = 0; i < cores; ++i) {
+        g_core_tlbs.push_back(make_unique<SoftwareTlb>());
+    }
+}
+
+// A new run must not inherit recency lists, ghosts or the ARC target
+void resetReplacementPolicy() {
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
+    if (g_replacement_policy) {
+        g_replacement_policy->reset(static_cast<int>(g_frame_table.size()));
+    }
+}
+
+void tlbStats(long long& hits, long long& misses) {
+    hits = 0;
+    misses = 0;
+    for (auto& tlb : g_core_tlbs) {
+        hits += tlb->hits.load(memory_order_relaxed);
+        misses += tlb->misses.load(memory_order_relaxed);
+    }
+}
+
+static int tlbIndex(uint64_t key) {
+    return static_cast<int>((key * 0x9E3779B97F4A7C15ULL) >> (64 - SoftwareTlb::INDEX_BITS));
+}
+
+// Caller holds g_paging_mutex, which also serializes the ring writers
+static void shootdownPage(uint64_t key) {
+    for (auto& tlb : g_core_tlbs) {
+        uint64_t generation = tlb->shootdown_generation.load(memory_order_relaxed);
+        tlb->shootdown_keys[generation % SoftwareTlb::SHOOTDOWN_RING].store(key, memory_order_relaxed);
+        tlb->shootdown_generation.store(generation + 1, memory_order_release);
+    }
+}
+
+// Apply the shootdowns posted to this core since it last looked
+static void syncTlb(SoftwareTlb& tlb) {
+    uint64_t generation = tlb.shootdown_generation.load(memory_order_acquire);
+    if (generation == tlb.seen_generation) return;
+    bool overrun = generation - tlb.seen_generation > SoftwareTlb::SHOOTDOWN_RING;
+    if (!overrun) {
+        for (uint64_t g = tlb.seen_generation; g < generation; ++g) {
+            uint64_t key = tlb.shootdown_keys[g % SoftwareTlb::SHOOTDOWN_RING].load(memory_order_relaxed);
+            SoftwareTlb::Entry& entry = tlb.entries[tlbIndex(key)];
+            if (entry.key == key) entry.key = 0;
+        }
+        // The ring may have lapped the slots while we read them
+        overrun = tlb.shootdown_generation.load(memory_order_acquire) - tlb.seen_generation >
+                  SoftwareTlb::SHOOTDOWN_RING;
+    }
+    if (overrun) {
+        for (auto& entry : tlb.entries) entry.key = 0;
+    }
+    tlb.seen_generation = generation;
+}
+
+static void releaseFrame(int frame, bool evicted) {
+    const FrameEntry& entry = g_frame_table[frame];
+    uint64_t key = pageKey(entry.pid, entry.page_number);
+    {
+        PolicyTimer timer;
+        g_replacement_policy->onRemove(frame, key, evicted);
+    }
+    shootdownPage(key);
+    g_frame_table[frame] = FrameEntry{};
+    g_free_frames.release(frame);
+}
+
+int freeFrameCount() {
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
+    return g_free_frames.freeCount();
+}
+
+// Record an access to a resident page. Hits are counted by the caller, since
+// only instruction accesses go into the hit ratio.
+static void touchPage(Page& page) {
+    page.last_access_tick = g_cpu_ticks.load(memory_order_relaxed);
+    PolicyTimer timer;
+    g_replacement_policy->onAccess(page.frame_number);
+}
+
+// Copy a queued store into its frame if the frame still holds that page.
+// Caller holds g_paging_mutex and the TLB's store_mutex.
+static void applyStore(SoftwareTlb::PendingStore& store) {
+    const FrameEntry& entry = g_frame_table[store.frame_number];
+    if (store.key == 0 || entry.pid == 0 || pageKey(entry.pid, entry.page_number) != store.key) return;
+    memcpy(frameBytes(store.frame_number) + store.offset, store.bytes, store.length);
+    processByPid(entry.pid)->page_table[entry.page_number].is_dirty = true;
+    store.key = 0;
+}
+
+// Write every store still queued on any core for the page in frame before
+// it is evicted, so its contents reach swap. Caller holds g_paging_mutex.
+static void writeQueuedStores(int frame) {
+    for (auto& tlb : g_core_tlbs) {
+        lock_guard<mutex> lock(tlb->store_mutex);
+        for (int i = 0; i < tlb->store_count; ++i) {
+            if (tlb->stores[i].frame_number == frame) applyStore(tlb->stores[i]);
+        }
+    }
+}
+
+// Copy in the core's queued stores, oldest first, and hand its queued TLB
+// hits to the policy. Caller holds g_paging_mutex.
+static void applyPendingTouches(SoftwareTlb& tlb) {
+    {
+        lock_guard<mutex> lock(tlb.store_mutex);
+        for (int i = 0; i < tlb.store_count; ++i) applyStore(tlb.stores[i]);
+        tlb.store_count = 0;
+    }
+    for (int i = 0; i < tlb.pending_count; ++i) {
+        const SoftwareTlb::PendingTouch& touch = tlb.pending[i];
+        const FrameEntry& entry = g_frame_table[touch.frame_number];
+        if (entry.pid == 0 || pageKey(entry.pid, entry.page_number) != touch.key) continue;  // evicted since
+        touchPage(processByPid(entry.pid)->page_table[entry.page_number]);
+    }
+    tlb.pending_count = 0;
+}
+
+const char* replacementPolicyName() {
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
+    return g_replacement_policy ? g_replacement_policy->name() : "none";
+}
+
+// Evict a resident page. Only dirty pages are written: a clean page's swap
+// slot still holds exactly what is in its frame. Caller holds g_paging_mutex.
+static void evictPage(Page& page) {
+    writeQueuedStores(page.frame_number);
+    if (page.is_dirty) {
+        if (page.swap_slot == -1 && !g_free_swap_slots.empty()) {
+            page.swap_slot = g_free_swap_slots.back();
+            g_free_swap_slots.pop_back();
+        }
+        if (page.swap_slot != -1) {
+            memcpy(g_swap_base + static_cast<size_t>(page.swap_slot) * g_mem_per_frame,
+                   frameBytes(page.frame_number), g_mem_per_frame);
+            g_swap_bytes_written += g_mem_per_frame;
+            page.is_dirty = false;
+        }
+    }
+    releaseFrame(page.frame_number, true);
+    page.is_in_memory = false;
+}
+
+// Fill a frame for a page being brought in: from its swap slot if it has
+// one, otherwise zeroed. Either way it starts clean; only a store dirties it,
+// so a page that was never written is dropped on eviction and re-zeroed on
+// its next fault without ever taking a swap slot.
+static void loadPage(Page& page) {
+    if (page.swap_slot != -1) {
+        memcpy(frameBytes(page.frame_number),
+               g_swap_base + static_cast<size_t>(page.swap_slot) * g_mem_per_frame, g_mem_per_frame);
+        g_swap_bytes_read += g_mem_per_frame;
+    } else {
+        memset(frameBytes(page.frame_number), 0, g_mem_per_frame);
+    }
+    page.is_dirty = false;
+}
+
+static void appendPagingEventText(string& out, const PagingEvent& event) {
+    if (event.type == PAGE_IN_EVENT) {
+        out += "PAGE IN: Process ";
+        out += event.process_name;
+        out += " Page " + to_string(event.page_number) + " to Frame " + to_string(event.frame_number) + "\n";
+    } else {
+        out += "PAGE OUT: Process ";
+        out += event.process_name;
+        out += " Page " + to_string(event.page_number) + " from Frame " + to_string(event.frame_number) + "\n";
+    }
+}
+
+// Drains the event ring in batches: one write and one flush per batch
+// instead of one per page fault. Exits once stopped and the ring is empty.
+static void backingStoreWriterThread() {
+    string batch;
+    PagingEvent event;
+    while (true) {
+        bool stopping = !g_backing_store_running.load();
+        batch.clear();
+        size_t records = 0;
+        while (records < BACKING_STORE_BATCH && g_backing_store_events.tryPop(event)) {
+            if (config_backing_store_format == BACKING_STORE_BINARY) {
+                batch.append(reinterpret_cast<const char*>(&event), sizeof(event));
+            } else {
+                appendPagingEventText(batch, event);
+            }
+            ++records;
+        }
+
+        if (records > 0) {
+            g_backing_store.write(batch.data(), batch.size());
+            g_backing_store.flush();
+        } else if (stopping) {
+            break;
+        } else {
+            this_thread::sleep_for(chrono::milliseconds(TICK_DURATION_MS));
+        }
+    }
+}
+
+void stopBackingStoreWriter() {
+    g_backing_store_running = false;
+    if (g_backing_store_thread.joinable()) {
+        g_backing_store_thread.join();
+    }
+}
+
+// ---- Compaction ----
+//
+// Random process sizes leave free space scattered in holes too small for the
+// next arrival. Once external fragmentation (the share of free bytes outside
+// the largest hole) reaches compaction-threshold percent, the allocation or
+// free that got it there wakes a background thread. It slides allocated
+// blocks down toward address 0, a bounded slice at a time so allocations and
+// frees interleave with it. Each slice resumes where the last
+// one stopped, and the pass ends once fragmentation is below
+// compaction-stop-threshold, so ordinary churn does not keep it running. A
+// failed admission that would fit in the total free space starts a pass
+// straight away, whatever the threshold, which runs until that process fits.
+// Only a block's placement changes: process contents live in page frames
+// indexed by page number, not by where the block sits. In virtual time the
+// slices run on the tick thread instead, one per tick.
+
+int config_compaction_threshold = 50;       // percent, 0 disables compaction
+int config_compaction_stop_threshold = 10;  // percent a pass brings it down to
+atomic<long long> g_compaction_moves(0);
+atomic<long long> g_compaction_bytes_moved(0);
+static const int COMPACTION_SLICE_MOVES = 16;  // blocks moved per slice at most
+static const chrono::microseconds COMPACTION_SLICE_BUDGET(50);
+static thread g_compactor_thread;
+static atomic<bool> g_compactor_running(false);
+static mutex g_compactor_wait_mutex;  // guards the request flag, a leaf lock
+static condition_variable g_compactor_cv;
+static bool g_compaction_requested = false;
+
+// State of the current pass, under g_memory_mutex
+static int g_compaction_cursor = 0;  // everything below is packed
+static int g_compaction_goal = 0;    // hole a blocked admission needs, 0 if none
+
+// Caller holds g_memory_mutex
+static bool fragmentedAtLeast(int percent) {
+    int free_bytes = g_memory_allocator->freeBytes();
+    if (free_bytes < g_min_mem_per_proc) return false;
+    long long scattered = free_bytes - g_memory_allocator->largestFreeExtent();
+    return 100 * scattered >= static_cast<long long>(percent) * free_bytes;
+}
+
+// A pass for a blocked admission stops as soon as it fits. Caller holds
+// g_memory_mutex.
+static bool compactionPassDone() {
+    if (g_compaction_goal > 0) return g_memory_allocator->largestFreeExtent() >= g_compaction_goal;
+    return !fragmentedAtLeast(config_compaction_stop_threshold);
+}
+
+// Where a pass for a blocked admission starts: the highest hole from which the
+// free space above adds up to needed_bytes, so only the blocks above it move.
+// Caller holds g_memory_mutex.
+static int compactionStart(int needed_bytes) {
+    vector<MemoryExtent> holes = g_memory_allocator->freeExtents();
+    int above = 0;
+    for (auto it = holes.rbegin(); it != holes.rend(); ++it) {
+        above += it->size;
+        if (above >= needed_bytes) return it->start;
+    }
+    return 0;
+}
+
+// Bytes a real relocation would copy: only the resident part of the block.
+// Pages out on swap just keep their slots. Caller holds g_memory_mutex.
+static int residentBytes(PCB* process) {
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
+    int pages = 0;
+    for (const Page& page : process->page_table) {
+        if (page.is_in_memory) ++pages;
+    }
+    return min(process->memory_block.size, pages * g_mem_per_frame);
+}
+
+// Move blocks, lowest address first, down to the cursor until the slice runs
+// out. Sets finished once no hole is left below a block.
+// Caller holds g_memory_mutex.
+static int compactSliceLocked(bool& finished) {
+    auto deadline = chrono::steady_clock::now() + COMPACTION_SLICE_BUDGET;
+    int moves = 0;
+    finished = false;
+
+    // A block allocated since the last slice may straddle the cursor
+    auto it = g_block_owners.lower_bound(g_compaction_cursor);
+    if (it != g_block_owners.begin()) {
+        const MemoryExtent& below = prev(it)->second->memory_block;
+        g_compaction_cursor = max(g_compaction_cursor, below.start + below.size);
+    }
+
+    while (it != g_block_owners.end()) {
+        PCB* process = it->second;
+        MemoryExtent& block = process->memory_block;
+        if (block.start > g_compaction_cursor) {
+            // Virtual time bounds a slice by moves only, so runs stay repeatable
+            if (moves == COMPACTION_SLICE_MOVES || (!g_virtual_time && chrono::steady_clock::now() >= deadline)) {
+                return moves;
+            }
+            // The range below the block is free, so releasing it and claiming
+            // the same size at the cursor always succeeds
+            MemoryExtent moved{g_compaction_cursor, block.size};
+            g_memory_allocator->release(block);
+            if (!g_memory_allocator->reserve(moved)) {
+                g_memory_allocator->reserve(block);
+                break;
+            }
+            it = g_block_owners.erase(it);
+            g_block_owners.emplace(moved.start, process);  // lands before it
+            block = moved;
+            ++moves;
+            g_compaction_moves++;
+            g_compaction_bytes_moved += residentBytes(process);
+        } else {
+            ++it;
+        }
+        g_compaction_cursor = block.start + block.size;
+    }
+    finished = true;
+    return moves;
+}
+
+// Consume a pending request. Checked without g_memory_mutex, so an idle
+// compactor never contends with allocations.
+static bool takeCompactionRequest() {
+    lock_guard<mutex> lock(g_compactor_wait_mutex);
+    bool requested = g_compaction_requested;
+    g_compaction_requested = false;
+    return requested;
+}
+
+// One round of the compactor: start a pass if one was requested, then move
+// at most one slice. Returns the blocks moved and whether a pass is still
+// under way.
+static int compactionStep(bool& in_pass, bool requested) {
+    int moves = 0;
+    {
+        lock_guard<ProfiledMutex> lock(g_memory_mutex);
+        if (!in_pass && requested) {
+            in_pass = true;
+            g_compaction_cursor = g_compaction_goal > 0 ? compactionStart(g_compaction_goal) : 0;
+        }
+        if (in_pass && !compactionPassDone()) {
+            bool finished;
+            moves = compactSliceLocked(finished);
+            in_pass = !finished;
+        } else {
+            in_pass = false;
+        }
+        if (!in_pass) g_compaction_goal = 0;
+    }
+
+    // Space has come together: let blocked cores retry admission
+    if (moves > 0) notifyDispatchEvent();
+    return moves;
+}
+
+// Sleeps until a request arrives, then runs the pass slice by slice
+static void compactorThread() {
+    bool in_pass = false;
+    while (g_compactor_running.load()) {
+        bool requested = false;
+        if (!in_pass) {
+            unique_lock<mutex> lock(g_compactor_wait_mutex);
+            g_compactor_cv.wait(lock, [] { return g_compaction_requested || !g_compactor_running.load(); });
+            if (!g_compactor_running.load()) return;
+            g_compaction_requested = false;
+            requested = true;
+        }
+        compactionStep(in_pass, requested);
+        if (in_pass) this_thread::yield();
+    }
+}
+
+// In virtual time there is no compactor thread racing the clock: the tick
+// thread runs one slice between ticks, while every core is parked.
+static bool g_tick_compaction_in_pass = false;
+
+void compactOnTick() {
+    if (!g_virtual_time || !g_compactor_running.load()) return;
+    bool requested = !g_tick_compaction_in_pass && takeCompactionRequest();
+    if (!g_tick_compaction_in_pass && !requested) return;
+    compactionStep(g_tick_compaction_in_pass, requested);
+}
+
+// Called under g_memory_mutex. The flag is set under the wait mutex, so a
+// compactor about to sleep cannot miss it. With needed_bytes the pass runs
+// until a hole that size exists, otherwise down to the stop threshold.
+static void requestCompaction(int needed_bytes) {
+    if (!g_compactor_running.load()) return;
+    g_compaction_goal = max(g_compaction_goal, needed_bytes);
+    {
+        lock_guard<mutex> lock(g_compactor_wait_mutex);
+        g_compaction_requested = true;
+    }
+    g_compactor_cv.notify_one();
+}
+
+// Allocations and frees are the only things that change fragmentation, so
+// they check the threshold instead of the compactor polling it. Caller holds
+// g_memory_mutex.
+static void checkFragmentation() {
+    if (g_compactor_running.load() && fragmentedAtLeast(config_compaction_threshold)) requestCompaction(0);
+}
+
+// Blocks of the buddy allocator sit where their size class puts them, so
+// there is nothing to compact
+static void startCompactor() {
+    if (config_compaction_threshold <= 0 || config_memory_allocator == ALLOC_BUDDY) return;
+    {
+        lock_guard<mutex> lock(g_compactor_wait_mutex);
+        g_compaction_requested = false;
+    }
+    g_compaction_goal = 0;
+    g_tick_compaction_in_pass = false;
+    g_compactor_running = true;
+    if (!g_virtual_time) g_compactor_thread = thread(compactorThread);
+}
+
+void stopCompactor() {
+    {
+        lock_guard<mutex> lock(g_compactor_wait_mutex);
+        g_compactor_running = false;
+    }
+    g_compactor_cv.notify_one();
+    if (g_compactor_thread.joinable()) {
+        g_compactor_thread.join();
+    }
+}
 
 void initializeMemory() {
-    lock_guard<mutex> lock(g_memory_mutex);
-    g_memory_blocks.clear();
-    g_memory_blocks.push_back({
-        0, 
-        g_max_overall_mem, 
-        true, 
-        ""
-    });
+    stopCompactor();
+    lock_guard<ProfiledMutex> lock(g_memory_mutex);
+    g_memory_allocator = makeMemoryAllocator(config_memory_allocator);
+    g_memory_allocator->reset(g_max_overall_mem);
+    g_used_memory = 0;
+    g_requested_memory = 0;
+    g_block_owners.clear();
+    g_compaction_moves = 0;
+    g_compaction_bytes_moved = 0;
+    startCompactor();
     
     // Initialize paging system
     initializePaging();
 }
 
 void initializePaging() {
-    lock_guard<mutex> lock(g_paging_mutex);
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
     
     // Initialize frame table
     int total_frames = g_max_overall_mem / g_mem_per_frame;
-    g_frame_table.assign(total_frames, false);
+    g_frame_table.assign(total_frames, FrameEntry{});
+    g_free_frames.reset(total_frames);
+    g_replacement_policy = makeReplacementPolicy(config_page_replacement);
+    g_replacement_policy->reset(total_frames);
     
-    // Clear page table
-    g_page_table.clear();
+    // Physical frames and a swap slot for every page the largest possible set
+    // of resident processes could own (at least its symbol table each)
+    g_physical_memory.assign(static_cast<size_t>(total_frames) * g_mem_per_frame, 0);
+    size_t max_processes = g_max_overall_mem / max(1, g_min_mem_per_proc);
+    int max_process_bytes = max(g_max_mem_per_proc, static_cast<int>(sizeof(RegisterFile::values)));
+    openSwapDevice(max_processes * calculatePagesRequired(max_process_bytes));
+    g_swap_bytes_written = 0;
+    g_swap_bytes_read = 0;
     
-    // Initialize backing store file
-    g_backing_store.open("csopesy-backing-store.txt", ios::out | ios::trunc);
+    // Initialize backing store file. The binary log is a bare array of
+    // PagingEvent records.
+    stopBackingStoreWriter();
+    if (g_backing_store.is_open()) g_backing_store.close();
+    PagingEvent stale;
+    while (g_backing_store_events.tryPop(stale)) {
+    }
+    if (config_backing_store_format == BACKING_STORE_BINARY) {
+        g_backing_store.open("csopesy-backing-store.bin", ios::out | ios::trunc | ios::binary);
+    } else {
+        g_backing_store.open("csopesy-backing-store.txt", ios::out | ios::trunc);
+        if (g_backing_store.is_open()) {
+            g_backing_store << "CSOPESY Backing Store - Paging Operations Log\n";
+            g_backing_store << "============================================\n";
+            g_backing_store.flush();
+        }
+    }
     if (g_backing_store.is_open()) {
-        g_backing_store << "CSOPESY Backing Store - Paging Operations Log\n";
-        g_backing_store << "============================================\n";
-        g_backing_store.flush();
+        g_backing_store_running = true;
+        g_backing_store_thread = thread(backingStoreWriterThread);
     }
     
     // Reset paging counters
     g_pages_paged_in = 0;
     g_pages_paged_out = 0;
+    g_page_hits = 0;
+    g_page_faults = 0;
+    g_instructions_executed = 0;
+    g_replacement_policy_ns = 0;
 }
 
 int calculatePagesRequired(int memorySize) {
@@ -52,344 +668,514 @@ int calculatePagesRequired(int memorySize) {
     return (memorySize + g_mem_per_frame - 1) / g_mem_per_frame;
 }
 
+static void printMemoryStateLocked(const char* context) {
+    cerr << "\nMemory State (" << context << "): " << g_used_memory << " bytes used, "
+         << g_memory_allocator->freeBytes() << " bytes free\n";
+    for (const auto& extent : g_memory_allocator->freeExtents()) {
+        cerr << "[" << extent.start << "-" << extent.start + extent.size - 1 << "] FREE\n";
+    }
+}
+
 void printMemoryState(const char* context) {
-    lock_guard<mutex> lock(g_memory_mutex);
-    cerr << "\nMemory State (" << context << "):\n";
-    for (const auto& block : g_memory_blocks) {
-        int end_addr = block.start_address + block.size - 1;
-        cerr << "[" << block.start_address << "-" << end_addr << "] "
-             << (block.is_free ? "FREE" : "USED by " + block.process_name) 
-             << "\n";
-    }
-}
-
-void verifyMemoryConsistency() {
-    int total_size = 0;
-    for (const auto& block : g_memory_blocks) {
-        total_size += block.size;
-        if (block.start_address < 0 || block.size <= 0) {
-            cerr << "MEMORY CORRUPTION DETECTED!" << endl;
-            printMemoryState("CORRUPTION");
-            exit(1);
+    lock_guard<ProfiledMutex> lock(g_memory_mutex);
+    printMemoryStateLocked(context);
+}
+
+// ---- Consistency audits ----
+//
+// A full audit cross-checks the allocator against the blocks processes hold,
+// and the frame table against every page table. Violations are reported with
+// context and counted; the simulation keeps running. Checked builds
+// (-DCSOPESY_CHECKED) also audit every audit-interval-th allocate/free; in
+// release builds those hooks compile to nothing and audits only run on demand.
+
+int config_audit_interval = 64;
+atomic<long long> g_audit_violations(0);
+static const int AUDIT_REPORT_LIMIT = 20;  // violations printed per audit
+
+struct AuditLog {
+    const char* context;
+    int violations = 0;
+
+    template <typename... Parts>
+    void fail(const Parts&... parts) {
+        if (++violations <= AUDIT_REPORT_LIMIT) {
+            cerr << "AUDIT (" << context << "): ";
+            (cerr << ... << parts);
+            cerr << "\n";
         }
     }
-    if (total_size != g_max_overall_mem) {
-        cerr << "MEMORY LEAK DETECTED! Expected: " 
-             << g_max_overall_mem << " Actual: " << total_size << endl;
-        exit(1);
-    }
-}
+};
 
-bool allocateMemoryFirstFit(PCB* process) {
-    lock_guard<mutex> lock(g_memory_mutex);
+static void auditAllocator(AuditLog& log) {
+    int total = g_memory_allocator->totalBytes();
+    int free_bytes = g_memory_allocator->freeBytes();
+    if (g_used_memory + free_bytes != total) {
+        log.fail(g_used_memory, " bytes used + ", free_bytes, " free != ", total, " managed");
+    }
 
-    int required_size = process->memory_requirement > 0 ? 
-                       process->memory_requirement : 
-                       g_min_mem_per_proc;
+    // Free extents and process blocks must tile without overlap
+    vector<pair<MemoryExtent, int>> extents;  // pid, 0 for free
+    int listed_free = 0;
+    for (const auto& extent : g_memory_allocator->freeExtents()) {
+        extents.push_back({extent, 0});
+        listed_free += extent.size;
+    }
+    if (listed_free != free_bytes) {
+        log.fail("free extents add up to ", listed_free, " bytes, allocator says ", free_bytes);
+    }
+    int held = 0;
+    int requested = 0;
+    size_t holders = 0;
+    int last_pid = highestPid();
+    for (int pid = 1; pid <= last_pid; ++pid) {
+        PCB* process = processByPid(pid);
+        if (!process || !process->is_allocated) continue;
+        extents.push_back({process->memory_block, pid});
+        ++holders;
+        auto owner = g_block_owners.find(process->memory_block.start);
+        if (owner == g_block_owners.end() || owner->second != process) {
+            log.fail(process->name, "'s block at ", process->memory_block.start, " is missing from the owner map");
+        }
+        held += process->memory_block.size;
+        requested += process->memory_requested;
+        if (process->memory_block.size < process->memory_requested) {
+            log.fail(process->name, " holds ", process->memory_block.size, " bytes but asked for ",
+                     process->memory_requested);
+        }
+    }
+    if (holders != g_block_owners.size()) {
+        log.fail(g_block_owners.size(), " blocks in the owner map, ", holders, " processes hold memory");
+    }
+    if (held != g_used_memory || requested != g_requested_memory) {
+        log.fail("processes hold ", held, "/", requested, " bytes (block/requested), counters say ",
+                 g_used_memory, "/", g_requested_memory);
+    }
 
-    // Check if already allocated
-    for (const auto& block : g_memory_blocks) {
-        if (!block.is_free && block.process_name == process->name) {
-            return false;
+    sort(extents.begin(), extents.end(),
+         [](const pair<MemoryExtent, int>& a, const pair<MemoryExtent, int>& b) { return a.first.start < b.first.start; });
+    int end = 0;
+    for (const auto& [extent, pid] : extents) {
+        if (extent.size <= 0 || extent.start < 0 || extent.start + extent.size > total) {
+            log.fail("extent [", extent.start, "+", extent.size, ") of pid ", pid, " is out of range");
+        } else if (extent.start < end) {
+            log.fail("extent [", extent.start, "+", extent.size, ") of pid ", pid, " overlaps the one before it");
         }
+        end = max(end, extent.start + extent.size);
     }
+}
 
-    // With paging, we need to check if we can fit ANY process in memory
-    // Even if not enough contiguous space, we can still allocate if frames are available
-    
-    // Search from the beginning (low addresses) for first fit
-    for (auto it = g_memory_blocks.begin(); it != g_memory_blocks.end(); ++it) {
-        if (it->is_free && it->size >= required_size) {
-            // Allocate at the start of this block
-            it->is_free = false;
-            it->process_name = process->name;
-            
-            // If we have remaining space, split the block
-            if (it->size > required_size) {
-                MemoryBlock new_block = {
-                    it->start_address + required_size,
-                    it->size - required_size,
-                    true,
-                    ""
-                };
-                it->size = required_size;
-                g_memory_blocks.insert(next(it), new_block);
+// Caller holds g_paging_mutex
+static void auditPaging(AuditLog& log) {
+    int last_pid = highestPid();
+    int free_frames = 0;
+    for (int frame = 0; frame < static_cast<int>(g_frame_table.size()); ++frame) {
+        const FrameEntry& entry = g_frame_table[frame];
+        if (entry.pid == 0) {
+            ++free_frames;
+            continue;
+        }
+        PCB* owner = entry.pid > 0 && entry.pid <= last_pid ? processByPid(entry.pid) : nullptr;
+        if (!owner) {
+            log.fail("frame ", frame, " belongs to unknown pid ", entry.pid);
+        } else if (entry.page_number < 0 || entry.page_number >= static_cast<int>(owner->page_table.size())) {
+            log.fail("frame ", frame, " holds page ", entry.page_number, " of ", owner->name,
+                     ", which has ", owner->page_table.size(), " pages");
+        } else {
+            const Page& page = owner->page_table[entry.page_number];
+            if (!page.is_in_memory || page.frame_number != frame) {
+                log.fail("frame ", frame, " holds ", owner->name, " page ", entry.page_number,
+                         " but the page says ", page.is_in_memory ? "frame " : "not resident, frame ",
+                         page.frame_number);
             }
-            
-            // Simulate memory access for paging
-            simulateMemoryAccess(process->name);
-            
-            verifyMemoryConsistency();
-            return true;
         }
     }
-    
-    // If normal allocation fails, check if we can use paging
-    // For this test case, with 1024MB needed and only 1024MB total,
-    // we need to page out other processes
-    
-    // Find if there are other processes in memory to page out
-    bool has_other_processes = false;
-    string process_to_evict = "";
-    
-    for (const auto& block : g_memory_blocks) {
-        if (!block.is_free && block.process_name != process->name) {
-            has_other_processes = true;
-            process_to_evict = block.process_name;
-            break;
-        }
+    if (free_frames != g_free_frames.freeCount()) {
+        log.fail(free_frames, " frames are unowned but the free-frame bitmap counts ", g_free_frames.freeCount());
     }
-    
-    if (has_other_processes && !process_to_evict.empty()) {
-        // Page out the other process
-        deallocateMemory(nullptr); // This will find and deallocate
-        
-        // Try allocation again after making space
-        for (auto it = g_memory_blocks.begin(); it != g_memory_blocks.end(); ++it) {
-            if (it->is_free && it->size >= required_size) {
-                it->is_free = false;
-                it->process_name = process->name;
-                
-                if (it->size > required_size) {
-                    MemoryBlock new_block = {
-                        it->start_address + required_size,
-                        it->size - required_size,
-                        true,
-                        ""
-                    };
-                    it->size = required_size;
-                    g_memory_blocks.insert(next(it), new_block);
+
+    vector<char> slot_used(g_swap_size / max(1, g_mem_per_frame), 0);
+    for (int pid = 1; pid <= last_pid; ++pid) {
+        PCB* process = processByPid(pid);
+        if (!process) continue;
+        for (int page_number = 0; page_number < static_cast<int>(process->page_table.size()); ++page_number) {
+            const Page& page = process->page_table[page_number];
+            if (page.is_in_memory) {
+                bool in_range = page.frame_number >= 0 && page.frame_number < static_cast<int>(g_frame_table.size());
+                if (!in_range || g_frame_table[page.frame_number].pid != pid ||
+                    g_frame_table[page.frame_number].page_number != page_number) {
+                    log.fail(process->name, " page ", page_number, " claims frame ", page.frame_number,
+                             ", which the frame table gives to someone else");
+                }
+            }
+            if (page.swap_slot != -1) {
+                if (page.swap_slot < 0 || page.swap_slot >= static_cast<int>(slot_used.size())) {
+                    log.fail(process->name, " page ", page_number, " has swap slot ", page.swap_slot, " out of range");
+                } else if (slot_used[page.swap_slot]++) {
+                    log.fail("swap slot ", page.swap_slot, " is shared, seen again at ", process->name,
+                             " page ", page_number);
                 }
-                
-                // Simulate memory access for paging
-                simulateMemoryAccess(process->name);
-                
-                verifyMemoryConsistency();
-                return true;
             }
         }
     }
+}
+
+// Caller holds g_memory_mutex
+static int auditMemoryLocked(const char* context) {
+    AuditLog log{context};
+    auditAllocator(log);
+    {
+        lock_guard<ProfiledMutex> paging_lock(g_paging_mutex);
+        auditPaging(log);
+    }
+    if (log.violations > 0) {
+        if (log.violations > AUDIT_REPORT_LIMIT) {
+            cerr << "AUDIT (" << context << "): " << log.violations - AUDIT_REPORT_LIMIT << " more not shown\n";
+        }
+        printMemoryStateLocked(context);
+        g_audit_violations += log.violations;
+    }
+    return log.violations;
+}
+
+int auditMemory(const char* context) {
+    lock_guard<ProfiledMutex> lock(g_memory_mutex);
+    return auditMemoryLocked(context);
+}
+
+#ifdef CSOPESY_CHECKED
+// Caller holds g_memory_mutex
+static void sampledMemoryAudit(const char* context) {
+    static long long operations = 0;
+    if (config_audit_interval > 0 && ++operations % config_audit_interval == 0) {
+        auditMemoryLocked(context);
+    }
+}
+#define MEMORY_AUDIT_POINT(context) sampledMemoryAudit(context)
+#else
+#define MEMORY_AUDIT_POINT(context) ((void)0)
+#endif
+
+int usedMemoryBytes() {
+    lock_guard<ProfiledMutex> lock(g_memory_mutex);
+    return g_used_memory;
+}
+
+FragmentationStats memoryFragmentation() {
+    lock_guard<ProfiledMutex> lock(g_memory_mutex);
+    return {g_requested_memory, g_used_memory, g_memory_allocator->freeBytes(),
+            g_memory_allocator->largestFreeExtent()};
+}
+
+const char* memoryAllocatorName() {
+    lock_guard<ProfiledMutex> lock(g_memory_mutex);
+    return g_memory_allocator ? g_memory_allocator->name() : "none";
+}
+
+bool allocateMemory(PCB* process) {
+    lock_guard<ProfiledMutex> lock(g_memory_mutex);
+
+    int required_size = process->memory_requirement > 0 ? 
+                       process->memory_requirement : 
+                       g_min_mem_per_proc;
+
+    // Check if already allocated
+    if (process->is_allocated) {
+        return false;
+    }
+
+    MemoryExtent block;
+    if (!g_memory_allocator->allocate(required_size, block)) {
+        // Enough memory, just not in one piece
+        if (g_memory_allocator->freeBytes() >= required_size) requestCompaction(required_size);
+        return false;
+    }
+    process->memory_block = block;
+    g_block_owners[block.start] = process;
+    process->memory_requested = required_size;
+    g_used_memory += block.size;
+    g_requested_memory += required_size;
     
-    return false;
+    // Simulate memory access for paging
+    simulateMemoryAccess(process);
+    
+    process->is_allocated = true;
+    checkFragmentation();
+    MEMORY_AUDIT_POINT("allocate");
+    return true;
 }
 
 void deallocateMemory(PCB* process) {
     if (process == nullptr) return;
     
-    string process_name = process->name;
-    
     // Page out all pages for this process first
     {
-        lock_guard<mutex> paging_lock(g_paging_mutex);
-        int pages_needed = calculatePagesRequired(g_min_mem_per_proc);
-        for (int page_num = 0; page_num < pages_needed; page_num++) {
-            for (auto& page : g_page_table) {
-                if (page.process_name == process_name && page.page_number == page_num && page.is_in_memory) {
-                    // Mark frame as free
-                    g_frame_table[page.frame_number] = false;
-                    page.is_in_memory = false;
-                    
-                    // Log page out
-                    if (g_backing_store.is_open()) {
-                        g_backing_store << "PAGE OUT: Process " << process_name 
-                                       << " Page " << page_num 
-                                       << " from Frame " << page.frame_number << "\n";
-                        g_backing_store.flush();
-                    }
-                    g_pages_paged_out++;
-                    break;
-                }
+        // The contents die with the process, so nothing is written back
+        lock_guard<ProfiledMutex> paging_lock(g_paging_mutex);
+        for (int page_num = 0; page_num < static_cast<int>(process->page_table.size()); page_num++) {
+            Page& page = process->page_table[page_num];
+            if (page.is_in_memory) {
+                releaseFrame(page.frame_number, false);
+                page.is_in_memory = false;
+                
+                logPagingEvent(PAGE_OUT_EVENT, process, page_num, page.frame_number);
+                g_pages_paged_out++;
             }
+            releaseSwapSlot(page);
         }
+        process->page_table.clear();
     }
     
-    // Then deallocate memory blocks
-    lock_guard<mutex> lock(g_memory_mutex);
-    for (auto it = g_memory_blocks.begin(); it != g_memory_blocks.end(); ) {
-        if (!it->is_free && it->process_name == process_name) {
-            it->is_free = true;
-            it->process_name.clear();
-
-            // Merge with previous free block if possible
-            if (it != g_memory_blocks.begin()) {
-                auto prev_it = prev(it);
-                if (prev_it->is_free) {
-                    prev_it->size += it->size;
-                    it = g_memory_blocks.erase(it);
-                    continue;
-                }
-            }
+    // Then return its block to the allocator
+    unique_lock<ProfiledMutex> lock(g_memory_mutex);
+    if (process->is_allocated) {
+        g_memory_allocator->release(process->memory_block);
+        g_block_owners.erase(process->memory_block.start);
+        g_used_memory -= process->memory_block.size;
+        g_requested_memory -= process->memory_requested;
+        process->memory_block = {-1, 0};
+        checkFragmentation();
+    }
+    process->is_allocated = false;
+    MEMORY_AUDIT_POINT("free");
+    lock.unlock();
 
-            // Merge with next free block if possible
-            if (next(it) != g_memory_blocks.end()) {
-                auto next_it = next(it);
-                if (next_it->is_free) {
-                    it->size += next_it->size;
-                    g_memory_blocks.erase(next_it);
-                    continue;
-                }
-            }
-            ++it;
-        } else {
-            ++it;
-        }
+    // Freed space may let a waiting process in
+    notifyDispatchEvent();
+}
+
+// Page-table entry of a process, created on first touch. Caller holds
+// g_paging_mutex.
+static Page& pageOf(PCB* process, int page_number) {
+    if (page_number >= static_cast<int>(process->page_table.size())) {
+        process->page_table.resize(page_number + 1);
     }
-    verifyMemoryConsistency();
+    return process->page_table[page_number];
 }
 
-void pageIn(const string& process_name, int page_number) {
-    lock_guard<mutex> lock(g_paging_mutex);
-    
-    // Find a free frame or select victim using LRU
-    int frame_to_use = -1;
-    int total_frames = g_max_overall_mem / g_mem_per_frame;
-    
+static void pageInLocked(PCB* process, int page_number) {
     // First try to find a free frame
-    for (int i = 0; i < total_frames; i++) {
-        if (!g_frame_table[i]) {
-            frame_to_use = i;
-            break;
-        }
-    }
+    int frame_to_use = g_free_frames.allocate();
     
-    // If no free frame, use LRU to select victim
+    {
+        PolicyTimer timer;
+        g_replacement_policy->onMiss(pageKey(process->id, page_number));
+    }
+
+    // If no free frame, ask the replacement policy for a victim
     if (frame_to_use == -1) {
-        int lru_page_idx = findLRUPage();
-        if (lru_page_idx != -1) {
-            // Page out the LRU page
-            g_page_table[lru_page_idx].is_in_memory = false;
-            frame_to_use = g_page_table[lru_page_idx].frame_number;
+        int victim_frame;
+        {
+            PolicyTimer timer;
+            victim_frame = g_replacement_policy->chooseVictim(pageKey(process->id, page_number));
+        }
+        if (victim_frame != -1) {
+            // Page out the victim and take its frame
+            FrameEntry victim = g_frame_table[victim_frame];
+            PCB* owner = processByPid(victim.pid);
+            evictPage(owner->page_table[victim.page_number]);
+            g_free_frames.take(victim_frame);
+            frame_to_use = victim_frame;
             
-            // Log page out
-            if (g_backing_store.is_open()) {
-                g_backing_store << "PAGE OUT: Process " << g_page_table[lru_page_idx].process_name 
-                               << " Page " << g_page_table[lru_page_idx].page_number 
-                               << " from Frame " << frame_to_use << "\n";
-                g_backing_store.flush();
-            }
+            logPagingEvent(PAGE_OUT_EVENT, owner, victim.page_number, frame_to_use);
             g_pages_paged_out++;
         }
     }
     
     if (frame_to_use != -1) {
         // Mark frame as used
-        g_frame_table[frame_to_use] = true;
-        
-        // Add or update page in page table
-        bool found = false;
-        for (auto& page : g_page_table) {
-            if (page.process_name == process_name && page.page_number == page_number) {
-                page.is_in_memory = true;
-                page.frame_number = frame_to_use;
-                page.last_access_time = time(nullptr);
-                found = true;
-                break;
-            }
+        g_frame_table[frame_to_use] = {process->id, page_number};
+        {
+            PolicyTimer timer;
+            g_replacement_policy->onLoad(frame_to_use, pageKey(process->id, page_number));
         }
         
-        if (!found) {
-            g_page_table.push_back({
-                page_number,
-                process_name,
-                true,
-                frame_to_use,
-                time(nullptr)
-            });
-        }
+        Page& page = pageOf(process, page_number);
+        page.is_in_memory = true;
+        page.frame_number = frame_to_use;
+        page.last_access_tick = g_cpu_ticks.load(memory_order_relaxed);
+        loadPage(page);
         
-        // Log page in
-        if (g_backing_store.is_open()) {
-            g_backing_store << "PAGE IN: Process " << process_name 
-                           << " Page " << page_number 
-                           << " to Frame " << frame_to_use << "\n";
-            g_backing_store.flush();
-        }
+        logPagingEvent(PAGE_IN_EVENT, process, page_number, frame_to_use);
         g_pages_paged_in++;
     }
 }
 
-void pageOut(const string& process_name, int page_number) {
-    lock_guard<mutex> lock(g_paging_mutex);
-    
-    for (auto& page : g_page_table) {
-        if (page.process_name == process_name && page.page_number == page_number && page.is_in_memory) {
-            // Mark frame as free
-            g_frame_table[page.frame_number] = false;
-            page.is_in_memory = false;
-            
-            // Log page out
-            if (g_backing_store.is_open()) {
-                g_backing_store << "PAGE OUT: Process " << process_name 
-                               << " Page " << page_number 
-                               << " from Frame " << page.frame_number << "\n";
-                g_backing_store.flush();
-            }
-            g_pages_paged_out++;
-            break;
-        }
-    }
+void pageIn(PCB* process, int page_number) {
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
+    pageInLocked(process, page_number);
 }
 
-int findLRUPage() {
-    time_t oldest_time = time(nullptr);
-    int lru_index = -1;
+void pageOut(PCB* process, int page_number) {
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
     
-    for (int i = 0; i < g_page_table.size(); i++) {
-        if (g_page_table[i].is_in_memory && g_page_table[i].last_access_time < oldest_time) {
-            oldest_time = g_page_table[i].last_access_time;
-            lru_index = i;
-        }
+    if (page_number >= static_cast<int>(process->page_table.size())) return;
+    Page& page = process->page_table[page_number];
+    if (page.is_in_memory) {
+        evictPage(page);
+        
+        logPagingEvent(PAGE_OUT_EVENT, process, page_number, page.frame_number);
+        g_pages_paged_out++;
     }
-    
-    return lru_index;
 }
 
-bool isProcessInMemory(const string& process_name) {
-    lock_guard<mutex> lock(g_paging_mutex);
+bool isProcessInMemory(PCB* process) {
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
     
-    for (const auto& page : g_page_table) {
-        if (page.process_name == process_name && page.is_in_memory) {
+    for (const auto& page : process->page_table) {
+        if (page.is_in_memory) {
             return true;
         }
     }
     return false;
 }
 
-void simulateMemoryAccess(const string& process_name) {
-    // Calculate how many pages this process needs (should be 4 pages for 1024 bytes)
-    int pages_needed = calculatePagesRequired(g_min_mem_per_proc);
-    
-    // For each page, simulate access and force paging
-    for (int page_num = 0; page_num < pages_needed; page_num++) {
-        bool page_found = false;
-        
-        {
-            lock_guard<mutex> lock(g_paging_mutex);
-            // Check if page is currently in memory
-            for (auto& page : g_page_table) {
-                if (page.process_name == process_name && page.page_number == page_num) {
-                    if (page.is_in_memory) {
-                        page.last_access_time = time(nullptr);
-                        page_found = true;
-                    }
-                    break;
-                }
+// TLB of the calling worker thread, null on the menu thread
+static SoftwareTlb* currentTlb() {
+    return t_core_id >= 0 && t_core_id < static_cast<int>(g_core_tlbs.size()) ? g_core_tlbs[t_core_id].get()
+                                                                             : nullptr;
+}
+
+void simulateMemoryAccess(PCB* process) {
+    // Pick the pages first; the stream belongs to the process, not the pager
+    int count = min(max(config_pages_per_instruction, 1), MAX_PAGES_PER_INSTRUCTION);
+    int pages[MAX_PAGES_PER_INSTRUCTION];
+    for (int i = 0; i < count; ++i) {
+        pages[i] = nextAccessPage(process);
+    }
+
+    // Worker threads try their TLB first; only misses go to the page table
+    SoftwareTlb* tlb = currentTlb();
+    int missed = count;
+    if (tlb) {
+        syncTlb(*tlb);
+        missed = 0;
+        for (int i = 0; i < count; ++i) {
+            uint64_t key = pageKey(process->id, pages[i]);
+            const SoftwareTlb::Entry& entry = tlb->entries[tlbIndex(key)];
+            if (entry.key == key) {
+                tlb->pending[tlb->pending_count++] = {key, entry.frame_number};
+            } else {
+                pages[missed++] = pages[i];
             }
         }
-        
-        // If page not in memory or doesn't exist, we need to page it in
-        // This will force eviction of other processes due to limited memory
-        if (!page_found) {
-            pageIn(process_name, page_num);
+        tlb->hits.store(tlb->hits.load(memory_order_relaxed) + count - missed, memory_order_relaxed);
+        tlb->misses.store(tlb->misses.load(memory_order_relaxed) + missed, memory_order_relaxed);
+        if (count > missed) g_page_hits += count - missed;
+        if (missed == 0 && tlb->pending_count + MAX_PAGES_PER_INSTRUCTION <= SoftwareTlb::TOUCH_BATCH) {
+            return;
         }
     }
+
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
+    if (tlb) applyPendingTouches(*tlb);
+    for (int i = 0; i < missed; ++i) {
+        Page& page = pageOf(process, pages[i]);
+        if (page.is_in_memory) {
+            touchPage(page);
+            g_page_hits++;
+        } else {
+            pageInLocked(process, pages[i]);
+            g_page_faults++;
+        }
+        if (tlb && page.is_in_memory) {
+            uint64_t key = pageKey(process->id, pages[i]);
+            tlb->entries[tlbIndex(key)] = {key, page.frame_number};
+        }
+    }
+}
+
+// Queue a store on the core's TLB if every page of the range is cached there
+// and both batches have room. The bytes are copied now, so the caller may
+// change them straight away. False means the caller must take the locked path.
+static bool queueStore(SoftwareTlb& tlb, PCB* process, int address, const char* bytes, int size) {
+    int first_page = address / g_mem_per_frame;
+    int last_page = (address + size - 1) / g_mem_per_frame;
+    int pages = last_page - first_page + 1;
+    int hits = 0;
+    for (int page_number = first_page; page_number <= last_page; ++page_number) {
+        uint64_t key = pageKey(process->id, page_number);
+        if (tlb.entries[tlbIndex(key)].key == key) ++hits;
+    }
+    tlb.hits.store(tlb.hits.load(memory_order_relaxed) + hits, memory_order_relaxed);
+    tlb.misses.store(tlb.misses.load(memory_order_relaxed) + pages - hits, memory_order_relaxed);
+    if (hits < pages || size > SoftwareTlb::MAX_STORE_BYTES ||
+        tlb.pending_count + pages + MAX_PAGES_PER_INSTRUCTION > SoftwareTlb::TOUCH_BATCH) {
+        return false;
+    }
+
+    lock_guard<mutex> lock(tlb.store_mutex);
+    if (tlb.store_count + pages > SoftwareTlb::STORE_BATCH) return false;
+    while (size > 0) {
+        int offset = address % g_mem_per_frame;
+        int length = min(size, g_mem_per_frame - offset);
+        uint64_t key = pageKey(process->id, address / g_mem_per_frame);
+        int frame_number = tlb.entries[tlbIndex(key)].frame_number;
+        SoftwareTlb::PendingStore& store = tlb.stores[tlb.store_count++];
+        store.key = key;
+        store.frame_number = frame_number;
+        store.offset = static_cast<uint16_t>(offset);
+        store.length = static_cast<uint16_t>(length);
+        memcpy(store.bytes, bytes, length);
+        tlb.pending[tlb.pending_count++] = {key, frame_number};
+        address += length;
+        bytes += length;
+        size -= length;
+    }
+    return true;
+}
+
+// Write bytes into a process's memory at a process-relative address, paging
+// in whatever part of the range is not resident. The pages become dirty.
+// On a worker core whose TLB maps the whole range the store is queued with
+// its pending touches and no lock is taken; the queued copy reaches the frame
+// at the next flush, or when the page is evicted.
+void storeProcessBytes(PCB* process, int address, const void* data, int size) {
+    if (size <= 0) return;
+    const char* bytes = static_cast<const char*>(data);
+    SoftwareTlb* tlb = currentTlb();
+    if (tlb) {
+        syncTlb(*tlb);
+        if (queueStore(*tlb, process, address, bytes, size)) return;
+    }
+
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
+    if (tlb) applyPendingTouches(*tlb);  // older queued stores land first
+    while (size > 0) {
+        int page_number = address / g_mem_per_frame;
+        int offset = address % g_mem_per_frame;
+        int length = min(size, g_mem_per_frame - offset);
+
+        if (!pageOf(process, page_number).is_in_memory) pageInLocked(process, page_number);
+        Page& page = process->page_table[page_number];
+        if (!page.is_in_memory) return;  // no frame could be freed for it
+
+        memcpy(frameBytes(page.frame_number) + offset, bytes, length);
+        page.is_dirty = true;
+        touchPage(page);
+        if (tlb) {
+            uint64_t key = pageKey(process->id, page_number);
+            tlb->entries[tlbIndex(key)] = {key, page.frame_number};
+        }
+        address += length;
+        bytes += length;
+        size -= length;
+    }
+}
+
+void flushPendingTouches() {
+    SoftwareTlb* tlb = currentTlb();
+    if (!tlb || (tlb->pending_count == 0 && tlb->store_count == 0)) return;
+    lock_guard<ProfiledMutex> lock(g_paging_mutex);
+    applyPendingTouches(*tlb);
 }
 
 void closePagingSystem() {
-    if (g_backing_store.is_open()) {
+    stopBackingStoreWriter();
+    if (g_backing_store.is_open() && config_backing_store_format == BACKING_STORE_TEXT) {
         g_backing_store << "\nPaging session ended.\n";
         g_backing_store << "Total pages paged in: " << g_pages_paged_in.load() << "\n";
         g_backing_store << "Total pages paged out: " << g_pages_paged_out.load() << "\n";
-        g_backing_store.close();
     }
+    g_backing_store.close();
 }
\ No newline at end of file
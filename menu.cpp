@@ -40,10 +40,11 @@ void printScreenCommands() {
     cout << "2. scheduler-stop" << endl;
     cout << "3. process-smi" << endl;
     cout << "4. vmstat" << endl;
-    cout << "5. screen -ls" << endl;
-    cout << "6. screen" << endl;
-    cout << "7. clear / cls" << endl; 
-    cout << "8. exit" << endl;
+    cout << "5. memory-audit" << endl;
+    cout << "6. screen -ls" << endl;
+    cout << "7. screen" << endl;
+    cout << "8. clear / cls" << endl; 
+    cout << "9. exit" << endl;
 }
 
 Console::Console(const string& name, int total) {
@@ -73,23 +74,16 @@ void clearScreen() {
 }
 
 void printVmstat() {
-    lock_guard<mutex> lock(g_memory_mutex);
-
     int total_memory = g_max_overall_mem;
-    int used_memory = 0;
-    int free_memory = 0;
-    
-    for (const auto& block : g_memory_blocks) {
-        if (block.is_free) {
-            free_memory += block.size;
-        } else {
-            used_memory += block.size;
-        }
-    }
+    int used_memory = usedMemoryBytes();
+    int free_memory = total_memory - used_memory;
 
     long long idle_ticks = g_idle_cpu_ticks.load();
     long long active_ticks = g_active_cpu_ticks.load();
     long long total_ticks = idle_ticks + active_ticks;
+    long long hits = g_page_hits.load();
+    long long faults = g_page_faults.load();
+    long long instructions = g_instructions_executed.load();
 
     printf("\n");
     printf("      %d K total memory\n", total_memory / 1024);
@@ -98,26 +92,47 @@ void printVmstat() {
     printf("      %lld idle cpu ticks\n", idle_ticks);
     printf("      %lld active cpu ticks\n", active_ticks);
     printf("      %lld total cpu ticks\n", total_ticks);
+    printf("      %lld process arrivals skipped (ready queue full)\n", g_generation_skipped.load());
+    printf("      %d free frames\n", freeFrameCount());
     printf("      %lld pages paged in\n", g_pages_paged_in.load());
     printf("      %lld pages paged out\n", g_pages_paged_out.load());
+    printf("      %lld bytes written to swap\n", g_swap_bytes_written.load());
+    printf("      %lld bytes read from swap\n", g_swap_bytes_read.load());
+    printf("      %lld blocks moved by compaction\n", g_compaction_moves.load());
+    printf("      %lld bytes moved by compaction\n", g_compaction_bytes_moved.load());
+    printf("      %s page replacement\n", replacementPolicyName());
+    long long tlb_hits, tlb_misses;
+    tlbStats(tlb_hits, tlb_misses);
+    printf("      %lld TLB hits\n", tlb_hits);
+    printf("      %lld TLB misses\n", tlb_misses);
+    printf("      %.2f%% TLB hit ratio\n", tlb_hits + tlb_misses > 0 ? 100.0 * tlb_hits / (tlb_hits + tlb_misses) : 0.0);
+    printf("      %.2f%% page hit ratio\n", hits + faults > 0 ? 100.0 * hits / (hits + faults) : 0.0);
+    printf("      %.2f page faults per 1000 instructions\n", instructions > 0 ? 1000.0 * faults / instructions : 0.0);
+    printf("      %.3f ms replacement policy cpu time\n", g_replacement_policy_ns.load() / 1e6);
+    printf("      %.2f avg dispatch latency (ticks)\n", averageDispatchLatency());
+    bool p99_exact = true;
+    unsigned long long p99 = dispatchLatencyPercentile(99.0, p99_exact);
+    if (p99_exact) {
+        printf("      %llu p99 dispatch latency (ticks)\n", p99);
+    } else {
+        printf("      >= %llu p99 dispatch latency (ticks, max %llu)\n", p99, maxDispatchLatency());
+    }
+    for (const LockStats& lock : collectLockStats()) {
+        long long acquisitions = max(1LL, lock.acquisitions);
+        printf("      %s lock: %lld acquired, %.2f%% contended, %.0f ns avg wait, %.0f ns avg hold\n",
+               lock.name, lock.acquisitions, 100.0 * lock.contended / acquisitions,
+               static_cast<double>(lock.wait_ns) / acquisitions, static_cast<double>(lock.hold_ns) / acquisitions);
+    }
 }
 
 void printProcessSmi() {
-    lock_guard<mutex> memory_lock(g_memory_mutex);
-    lock_guard<mutex> process_lock(g_process_lists_mutex);
-
     // Calculate memory statistics
     int total_memory = g_max_overall_mem;
-    int used_memory = 0;
-    int free_memory = 0;
-    
-    for (const auto& block : g_memory_blocks) {
-        if (block.is_free) {
-            free_memory += block.size;
-        } else {
-            used_memory += block.size;
-        }
-    }
+    int used_memory = usedMemoryBytes();
+    FragmentationStats fragmentation = memoryFragmentation();
+    const char* allocator_name = memoryAllocatorName();
+
+    lock_guard<ProfiledMutex> memory_lock(g_memory_mutex);  // keeps memory_block stable
 
     cout << "\n";
     cout << "+-----------------------------------------------------------------------------------------+" << endl;
@@ -138,6 +153,15 @@ void printProcessSmi() {
          << "Memory Usage: " << used_memory / 1024 << "MiB / " << total_memory / 1024 << "MiB      "
          << "Memory Util: " << fixed << setprecision(0) 
          << (total_memory > 0 ? (double)used_memory / total_memory * 100.0 : 0.0) << "%   |" << endl;
+
+    int internal_bytes = fragmentation.used_bytes - fragmentation.requested_bytes;
+    int external_bytes = fragmentation.free_bytes - fragmentation.largest_free_bytes;
+    cout << "| Allocator: " << allocator_name
+         << "      Internal Frag: " << internal_bytes << " B ("
+         << (fragmentation.used_bytes > 0 ? (double)internal_bytes / fragmentation.used_bytes * 100.0 : 0.0) << "%)"
+         << "      External Frag: " << external_bytes << " B ("
+         << (fragmentation.free_bytes > 0 ? (double)external_bytes / fragmentation.free_bytes * 100.0 : 0.0) << "%)   |" << endl;
+    cout << "| Arrivals skipped (ready queue full): " << g_generation_skipped.load() << "   |" << endl;
     
     cout << "+-----------------------------------------------------------------------------------------+" << endl;
     cout << "|                                 Running processes and memory usage:                    |" << endl;
@@ -145,20 +169,12 @@ void printProcessSmi() {
     cout << "| Process ID |   Process Name   |    Memory Usage    |" << endl;
     cout << "+-----------------------------------------------------------------------------------------+" << endl;
 
-    // Get memory usage for each process from memory blocks
-    map<string, int> process_memory_usage;
-    for (const auto& block : g_memory_blocks) {
-        if (!block.is_free && !block.process_name.empty()) {
-            process_memory_usage[block.process_name] += block.size;
-        }
-    }
-
     // Display running processes
     bool has_running_processes = false;
     for (int i = 0; i < config_num_cpu; ++i) {
-        if (g_running_processes[i] != nullptr) {
-            PCB* process = g_running_processes[i];
-            int memory_usage = process_memory_usage[process->name];
+        PCB* process = g_running_processes[i].load();
+        if (process != nullptr) {
+            int memory_usage = process->is_allocated ? process->memory_block.size : 0;
             
             cout << "| " << setw(10) << process->id 
                  << " | " << setw(15) << process->name 
@@ -206,7 +222,6 @@ void screenSession(Console& screen) {
                 g_keep_generating = true;  // Enable generation
                 g_exit_flag = false;  // Make sure exit flag is reset
                 g_tick_thread = thread(tick_generator_thread);
-                g_scheduler_thread = thread(schedulerThread);
                 
                 for (int i = 0; i < config_num_cpu; ++i) {
                     if (current_scheduler_type == FCFS) {
@@ -217,14 +232,6 @@ void screenSession(Console& screen) {
                 }
                 g_threads_started = true;
                 
-                // Start generation thread
-                thread([](string screenName) {
-                    while (g_keep_generating && !g_exit_flag) {
-                        createTestProcesses(screenName);
-                        this_thread::sleep_for(chrono::milliseconds(100)); // Faster generation for test
-                    }
-                }, screen.name).detach();
-                
                 cout << "Scheduler started. Generating processes for paging test..." << endl;
             } else {
                 cout << "Scheduler is already running." << endl;
@@ -239,6 +246,14 @@ void screenSession(Console& screen) {
             screen.currentLine++;
         }  else if (screenCmd == "vmstat") {
             printVmstat();
+        } else if (screenCmd == "memory-audit") {
+            int violations = auditMemory("memory-audit");
+            if (violations == 0) {
+                cout << "Memory audit passed: allocator, frame table and page tables agree." << endl;
+            } else {
+                cout << "Memory audit found " << violations << " violation(s); details on stderr." << endl;
+            }
+            screen.currentLine++;
         }
         else if (screenCmd == "screen -ls") {
             string report = getSystemReport();
@@ -267,7 +282,7 @@ void menuSession() {
             if (command == "initialize") {
                 initialized = true;
                 readConfigFile();
-                g_running_processes.assign(config_num_cpu, nullptr);
+                initializeCores();
                 clearScreen();
                 printMenuCommands();
                 printConfigVars();
@@ -378,9 +393,8 @@ void menuSession() {
             }
             
             // Create a new process with custom instructions
-            static int custom_process_counter = 1;
             auto new_pcb = make_unique<PCB>(
-                custom_process_counter++,
+                0,  // PID assigned by the registry
                 process_name,
                 RUNNING,
                 time(0),
@@ -390,6 +404,7 @@ void menuSession() {
                 -1,
                 mem_size
             );
+            registerProcess(new_pcb.get());
             
             // Create screen session
             Console newScreen(process_name, mem_size);
@@ -408,7 +423,7 @@ void menuSession() {
                 
                 // Add to finished processes
                 {
-                    lock_guard<mutex> lock(g_process_lists_mutex);
+                    lock_guard<ProfiledMutex> lock(g_process_lists_mutex);
                     g_finished_processes.push_back(new_pcb.get());
                 }
                 
@@ -420,13 +435,16 @@ void menuSession() {
                 
                 // Add to finished processes
                 {
-                    lock_guard<mutex> lock(g_process_lists_mutex);
+                    lock_guard<ProfiledMutex> lock(g_process_lists_mutex);
                     g_finished_processes.push_back(new_pcb.get());
                 }
             }
             
             // Add to storage
-            g_process_storage.push_back(std::move(new_pcb));
+            {
+                lock_guard<ProfiledMutex> lock(g_process_lists_mutex);
+                g_process_storage.push_back(std::move(new_pcb));
+            }
         } else if (command.find("screen -r ") == 0) {
             string name = command.substr(10);
             if (name.empty()) {
@@ -437,12 +455,13 @@ void menuSession() {
                 bool process_exists = false;
                 
                 {
-                    lock_guard<mutex> lock(g_process_lists_mutex);
+                    lock_guard<ProfiledMutex> lock(g_process_lists_mutex);
                     
                     // First check running processes
                     for (int i = 0; i < config_num_cpu; ++i) {
-                        if (g_running_processes[i] && g_running_processes[i]->name == name) {
-                            target_process = g_running_processes[i];
+                        PCB* running = g_running_processes[i].load();
+                        if (running && running->name == name) {
+                            target_process = running;
                             process_exists = true;
                             break;
                         }
@@ -459,15 +478,10 @@ void menuSession() {
                         }
                     }
                     
-                    // If still not found, check process storage
+                    // If still not found, look the name up in the registry
                     if (!target_process) {
-                        for (const auto& stored_process : g_process_storage) {
-                            if (stored_process->name == name) {
-                                target_process = stored_process.get();
-                                process_exists = true;
-                                break;
-                            }
-                        }
+                        target_process = findProcess(name);
+                        process_exists = target_process != nullptr;
                     }
                 }
                 
@@ -491,11 +505,7 @@ void menuSession() {
                     cout << "Status: Finished!" << endl;
                     
                     cout << "\n==== PROCESS OUTPUT ====" << endl;
-                    if (!target_process->logs.empty()) {
-                        for (const auto& log : target_process->logs) {
-                            cout << log << endl;
-                        }
-                    } else {
+                    if (!printProcessLogs(target_process)) {
                         cout << "No output recorded." << endl;
                     }
                     cout << "=========================" << endl;
@@ -1,37 +1,314 @@
 // process.cpp
 #include "headers.h"
 #include <filesystem>  // Required for filesystem operations
+#include <cstring>
 namespace fs = std::filesystem;  // Namespace alias for cleaner code
 
-queue<PCB*> g_ready_queue;
-mutex g_ready_queue_mutex;
-vector<PCB*> g_running_processes;
+const size_t READY_QUEUE_CAPACITY = 65536;
+MPMCQueue<PCB*> g_ready_queue(READY_QUEUE_CAPACITY);
+unique_ptr<atomic<PCB*>[]> g_running_processes;
 vector<PCB*> g_finished_processes;
-mutex g_process_lists_mutex;
+ProfiledMutex g_process_lists_mutex("process lists");
 atomic<bool> g_exit_flag(false);
 vector<unique_ptr<PCB>> g_process_storage;
-thread g_scheduler_thread;
+
+vector<unique_ptr<CoreRunQueue>> g_core_run_queues;
 vector<thread> g_worker_threads;
 atomic<bool> g_threads_started(false);
 const int TICK_DURATION_MS = 10;
 atomic<unsigned long long> g_cpu_ticks(0);
-mutex g_tick_mutex;
-condition_variable g_tick_cv;
 thread g_tick_thread;
 atomic<bool> g_keep_generating(false);
 atomic<long long> g_idle_cpu_ticks(0);
 atomic<long long> g_active_cpu_ticks(0);
+atomic<long long> g_generation_skipped(0);  // arrivals dropped because the ready ring was full
+atomic<unsigned long long> g_dispatch_events(0);
 atomic<long long> g_pages_paged_in(0);
 atomic<long long> g_pages_paged_out(0);
+bool g_virtual_time = false;
+vector<unique_ptr<CoreTickSlot>> g_core_tick_slots;
+
+// Virtual time: number of cores inside parkCore, and the condition variable
+// the tick thread blocks on until the last of them parks
+static mutex g_parked_mutex;
+static condition_variable g_parked_cv;
+static int g_parked_cores = 0;
+
+// The generator used to run on its own thread every 100 ms; it now runs on
+// tick boundaries so virtual time produces the same arrival pattern.
+const int PROCESS_GEN_INTERVAL_TICKS = 100 / TICK_DURATION_MS;
+
+// Number of the next generated process. It names the process and selects its
+// seed stream, so scheduler-stop rewinds it to replay the same run.
+static int g_generated_process_count = 1;
+
+// Core id of the calling worker thread, -1 on the menu thread.
+thread_local int t_core_id = -1;
+
+// Instructions the calling core has run in tick t_budget_tick; delay-0 in
+// virtual time only.
+thread_local unsigned long long t_budget_tick = 0;
+thread_local int t_budget_used = 0;
+
+// Ready-to-running latency histogram, one bucket per tick. Latencies past the
+// last bucket are only counted, along with the slowest one seen, so a
+// percentile that lands there is reported as a lower bound.
+const int DISPATCH_LATENCY_BUCKETS = 1024;
+atomic<long long> g_dispatch_latency_hist[DISPATCH_LATENCY_BUCKETS];
+atomic<long long> g_dispatch_latency_overflow(0);
+atomic<unsigned long long> g_dispatch_latency_max(0);
+atomic<long long> g_dispatch_count(0);
+atomic<long long> g_dispatch_latency_total(0);
+
+// PID registry. PIDs are dense, starting at 1, and index a table of fixed
+// chunks that never move once allocated, so processByPid is a plain load with
+// no lock. Registration and name lookups take g_registry_mutex.
+const int PID_CHUNK_SIZE = 4096;
+const int MAX_PID_CHUNKS = 4096;  // room for 16M processes per run
+static unique_ptr<PCB*[]> g_pid_chunks[MAX_PID_CHUNKS];
+static unordered_map<string, int> g_pid_by_name;
+static int g_next_pid = 1;
+static ProfiledMutex g_registry_mutex("registry");
+
+int registerProcess(PCB* process) {
+    lock_guard<ProfiledMutex> lock(g_registry_mutex);
+    int pid = g_next_pid;
+    int chunk = pid / PID_CHUNK_SIZE;
+    if (chunk >= MAX_PID_CHUNKS) {
+        throw runtime_error("process registry full");
+    }
+    if (!g_pid_chunks[chunk]) {
+        g_pid_chunks[chunk].reset(new PCB*[PID_CHUNK_SIZE]());
+    }
+    g_pid_chunks[chunk][pid % PID_CHUNK_SIZE] = process;
+    g_pid_by_name[process->name] = pid;  // a reused name now means the newest process
+    ++g_next_pid;
+    process->id = pid;
+    return pid;
+}
+
+// Valid for any PID handed out since the last reset
+PCB* processByPid(int pid) {
+    return g_pid_chunks[pid / PID_CHUNK_SIZE][pid % PID_CHUNK_SIZE];
+}
+
+PCB* findProcess(const string& name) {
+    lock_guard<ProfiledMutex> lock(g_registry_mutex);
+    auto it = g_pid_by_name.find(name);
+    return it == g_pid_by_name.end() ? nullptr : processByPid(it->second);
+}
+
+// Every PID from 1 up to this one has been handed out
+int highestPid() {
+    lock_guard<ProfiledMutex> lock(g_registry_mutex);
+    return g_next_pid - 1;
+}
+
+// Only once no thread can still hold a PID, i.e. with the process storage
+static void resetProcessRegistry() {
+    lock_guard<ProfiledMutex> lock(g_registry_mutex);
+    for (auto& chunk : g_pid_chunks) {
+        chunk.reset();
+    }
+    g_pid_by_name.clear();
+    g_next_pid = 1;
+}
+
+// Requeue a process that is already accounted for. Generation keeps the ring
+// from filling, so this only spins if something else has gone wrong.
+void pushReadyProcess(PCB* process) {
+    while (!g_ready_queue.tryPush(process)) {
+        this_thread::yield();
+    }
+}
+
+// Something a core could act on has happened: a process was enqueued or
+// requeued, a core finished its process, or memory was freed. Only cores
+// parked on an event are woken, each through its own slot.
+void notifyDispatchEvent() {
+    g_dispatch_events++;
+    for (auto& slot : g_core_tick_slots) {
+        if (slot->waiting_for_event.load()) {
+            lock_guard<mutex> lock(slot->slot_mutex);
+            slot->slot_cv.notify_one();
+        }
+    }
+}
+
+// Wake every parked core regardless of what it is waiting for (shutdown),
+// and the tick thread if it is waiting for them.
+void wakeAllCores() {
+    for (auto& slot : g_core_tick_slots) {
+        lock_guard<mutex> lock(slot->slot_mutex);
+        slot->slot_cv.notify_one();
+    }
+    lock_guard<mutex> lock(g_parked_mutex);
+    g_parked_cv.notify_one();
+}
+
+// Park the calling core on its slot until the clock reaches target_tick or,
+// if wake_on_event is set, a dispatch event newer than seen_event arrives.
+// Both flags are published before the predicate is checked, so a tick or
+// event racing with the park is never missed. In virtual time the last core
+// to park wakes the tick thread.
+void parkCore(unsigned long long target_tick, bool wake_on_event, unsigned long long seen_event) {
+    CoreTickSlot& slot = *g_core_tick_slots[t_core_id];
+    unique_lock<mutex> lock(slot.slot_mutex);
+    slot.waiting_for_tick = target_tick;
+    slot.waiting_for_event = wake_on_event;
+    if (g_virtual_time) {
+        lock_guard<mutex> parked_lock(g_parked_mutex);
+        if (++g_parked_cores == config_num_cpu) g_parked_cv.notify_one();
+    }
+    slot.slot_cv.wait(lock, [&]{
+        return g_cpu_ticks.load() >= target_tick ||
+               (wake_on_event && g_dispatch_events.load() != seen_event) ||
+               g_exit_flag.load();
+    });
+    if (g_virtual_time) {
+        lock_guard<mutex> parked_lock(g_parked_mutex);
+        --g_parked_cores;
+    }
+    slot.waiting_for_event = false;
+    slot.waiting_for_tick = 0;
+}
+
+// Block an idle core until a dispatch event newer than seen_event arrives.
+// After a failed allocation the core also retries on the next tick, so a
+// process that cannot fit never wedges the ones queued behind it.
+// In virtual time an idle core always parks for just the next tick, so the
+// clock cannot run ahead of a core that has not looked at the queues yet.
+void waitForDispatchEvent(unsigned long long seen_event, bool retry_next_tick) {
+    flushPendingTouches();  // nothing we queued may wait out an idle spell
+    unsigned long long start_tick = g_cpu_ticks.load();
+    if (g_virtual_time) {
+        parkCore(start_tick + 1, false, seen_event);
+    } else {
+        parkCore(retry_next_tick ? start_tick + 1 : ULLONG_MAX, true, seen_event);
+    }
+    g_idle_cpu_ticks += g_cpu_ticks.load() - start_tick;
+}
+
+// Park the calling core until the clock reaches target_tick; the tick thread
+// wakes it exactly once. The menu thread (screen -c) has no slot, so it just
+// sleeps wall time.
+void waitUntilTick(unsigned long long target_tick) {
+    if (t_core_id < 0) {
+        unsigned long long now = g_cpu_ticks.load();
+        if (target_tick > now) {
+            this_thread::sleep_for(chrono::milliseconds((target_tick - now) * TICK_DURATION_MS));
+        }
+        return;
+    }
+    parkCore(target_tick, false, 0);
+}
+
+// True once every core is parked on a tick later than current_tick, i.e. it
+// has finished all of its work for current_tick.
+bool allCoresParked(unsigned long long current_tick) {
+    for (auto& slot : g_core_tick_slots) {
+        if (slot->waiting_for_tick.load() <= current_tick) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void recordDispatchLatency(unsigned long long ticks) {
+    if (ticks < DISPATCH_LATENCY_BUCKETS) {
+        g_dispatch_latency_hist[ticks]++;
+    } else {
+        g_dispatch_latency_overflow++;
+    }
+    unsigned long long slowest = g_dispatch_latency_max.load();
+    while (ticks > slowest && !g_dispatch_latency_max.compare_exchange_weak(slowest, ticks)) {
+    }
+    g_dispatch_latency_total += static_cast<long long>(ticks);
+    g_dispatch_count++;
+}
+
+vector<LockStats> collectLockStats() {
+    LockStats run_queues = {"run queues", 0, 0, 0, 0};
+    for (auto& run_queue : g_core_run_queues) {
+        LockStats core = run_queue->queue_mutex.stats();
+        run_queues.acquisitions += core.acquisitions;
+        run_queues.contended += core.contended;
+        run_queues.wait_ns += core.wait_ns;
+        run_queues.hold_ns += core.hold_ns;
+    }
+    return {g_process_lists_mutex.stats(), run_queues, g_memory_mutex.stats(),
+            g_paging_mutex.stats(), g_registry_mutex.stats()};
+}
+
+void resetLockStats() {
+    g_process_lists_mutex.resetStats();
+    for (auto& run_queue : g_core_run_queues) {
+        run_queue->queue_mutex.resetStats();
+    }
+    g_memory_mutex.resetStats();
+    g_paging_mutex.resetStats();
+    g_registry_mutex.resetStats();
+}
 
+double averageDispatchLatency() {
+    long long count = g_dispatch_count.load();
+    return count > 0 ? static_cast<double>(g_dispatch_latency_total.load()) / count : 0.0;
+}
+
+unsigned long long dispatchLatencyPercentile(double percentile, bool& exact) {
+    exact = true;
+    long long count = g_dispatch_count.load();
+    if (count == 0) return 0;
+    long long rank = static_cast<long long>(count * percentile / 100.0 + 0.5);
+    if (rank < 1) rank = 1;
+    long long seen = 0;
+    for (int i = 0; i < DISPATCH_LATENCY_BUCKETS; ++i) {
+        seen += g_dispatch_latency_hist[i].load();
+        if (seen >= rank) return i;
+    }
+    exact = false;
+    return DISPATCH_LATENCY_BUCKETS;
+}
+
+unsigned long long maxDispatchLatency() {
+    return g_dispatch_latency_max.load();
+}
+
+// Wall-clock mode advances the clock every TICK_DURATION_MS. Virtual-time
+// mode is a discrete-event loop: the clock advances as soon as every core has
+// parked, so the simulation runs as fast as the cores can execute. A core
+// parked but not yet woken from the last tick still shows an old target, so
+// the count alone is not enough and allCoresParked has the final say.
 void tick_generator_thread() {
     while (!g_exit_flag) {
-        this_thread::sleep_for(chrono::milliseconds(TICK_DURATION_MS));
-        {
-            lock_guard<mutex> lock(g_tick_mutex);
-            g_cpu_ticks++;
+        unsigned long long current_tick = g_cpu_ticks.load();
+        if (g_virtual_time) {
+            unique_lock<mutex> lock(g_parked_mutex);
+            g_parked_cv.wait(lock, [&]{
+                return (g_parked_cores == config_num_cpu && allCoresParked(current_tick)) ||
+                       g_exit_flag.load();
+            });
+            if (g_exit_flag) break;
+        } else {
+            this_thread::sleep_for(chrono::milliseconds(TICK_DURATION_MS));
+        }
+
+        // Arrivals for the next tick are queued before any core sees it
+        if (g_keep_generating && (current_tick + 1) % PROCESS_GEN_INTERVAL_TICKS == 0) {
+            createTestProcesses();
+        }
+
+        compactOnTick();
+
+        // Wake only the cores whose target tick has arrived
+        unsigned long long now = ++g_cpu_ticks;
+        for (auto& slot : g_core_tick_slots) {
+            unsigned long long target = slot->waiting_for_tick.load();
+            if (target != 0 && target <= now) {
+                lock_guard<mutex> lock(slot->slot_mutex);
+                slot->slot_cv.notify_one();
+            }
         }
-        g_tick_cv.notify_all();
     }
 }
 
@@ -43,15 +320,12 @@ void stopAndResetScheduler() {
     g_keep_generating = false;
     
     // Wake up any waiting threads
-    g_tick_cv.notify_all();
+    wakeAllCores();
     
     // Wait for threads to finish with timeout
     if (g_tick_thread.joinable()) {
         g_tick_thread.join();
     }
-    if (g_scheduler_thread.joinable()) {
-        g_scheduler_thread.join();
-    }
     
     // Clear worker threads
     for (auto& worker : g_worker_threads) {
@@ -63,18 +337,24 @@ void stopAndResetScheduler() {
     
     // Clean up process queues and memory
     {
-        lock_guard<mutex> lock(g_process_lists_mutex);
+        lock_guard<ProfiledMutex> lock(g_process_lists_mutex);
         
-        // Clear ready queue
-        while (!g_ready_queue.empty()) {
-            g_ready_queue.pop();
+        // Clear ready queue and per-core run queues
+        PCB* discarded = nullptr;
+        while (g_ready_queue.tryPop(discarded)) {
+        }
+        for (auto& run_queue : g_core_run_queues) {
+            lock_guard<ProfiledMutex> queue_lock(run_queue->queue_mutex);
+            run_queue->processes.clear();
         }
         
-        // Deallocate running processes
+        // Deallocate running and preempted processes
         for (int i = 0; i < config_num_cpu; ++i) {
-            if (g_running_processes[i] != nullptr) {
-                deallocateMemory(g_running_processes[i]);
-                g_running_processes[i] = nullptr;
+            g_running_processes[i].store(nullptr);
+        }
+        for (auto& stored_process : g_process_storage) {
+            if (stored_process->is_allocated) {
+                deallocateMemory(stored_process.get());
             }
         }
         
@@ -83,7 +363,13 @@ void stopAndResetScheduler() {
         
         // Clear process storage
         g_process_storage.clear();
+        resetProcessRegistry();
     }
+
+    // PIDs start over, so cached translations, queued hits and the
+    // replacement history keyed by them must go
+    initializeTlbs(config_num_cpu);
+    resetReplacementPolicy();
     
     // Reset scheduler state
     g_threads_started = false;
@@ -91,8 +377,21 @@ void stopAndResetScheduler() {
     
     // Reset CPU tick counters
     g_cpu_ticks = 0;
+    for (auto& slot : g_core_tick_slots) {
+        slot->waiting_for_tick = 0;
+    }
     g_idle_cpu_ticks = 0;
     g_active_cpu_ticks = 0;
+    g_generation_skipped = 0;
+    for (auto& bucket : g_dispatch_latency_hist) {
+        bucket = 0;
+    }
+    g_dispatch_latency_overflow = 0;
+    g_dispatch_latency_max = 0;
+    g_dispatch_count = 0;
+    g_dispatch_latency_total = 0;
+    resetLockStats();
+    g_generated_process_count = 1;
     
     // Close paging system
     closePagingSystem();
@@ -100,232 +399,261 @@ void stopAndResetScheduler() {
     cout << "Scheduler stopped and reset successfully." << endl;
 }
 
-void schedulerThread() {
-    while (!g_exit_flag) {
-        PCB* process_to_schedule = nullptr;
-        {
-            lock_guard<mutex> lock(g_ready_queue_mutex);
-            if (!g_ready_queue.empty()) {
-                process_to_schedule = g_ready_queue.front();
-                g_ready_queue.pop();
-            }
+void initializeCores() {
+    g_core_run_queues.clear();
+    g_core_tick_slots.clear();
+    g_running_processes.reset(new atomic<PCB*>[config_num_cpu]);
+    for (int i = 0; i < config_num_cpu; ++i) {
+        g_running_processes[i].store(nullptr);
+        g_core_run_queues.push_back(make_unique<CoreRunQueue>());
+        g_core_tick_slots.push_back(make_unique<CoreTickSlot>());
+    }
+    initializeTlbs(config_num_cpu);
+}
+
+size_t readyProcessCount() {
+    size_t count = g_ready_queue.size();
+    for (auto& run_queue : g_core_run_queues) {
+        lock_guard<ProfiledMutex> lock(run_queue->queue_mutex);
+        count += run_queue->processes.size();
+    }
+    return count;
+}
+
+void pushLocalProcess(int core_id, PCB* process) {
+    {
+        CoreRunQueue& run_queue = *g_core_run_queues[core_id];
+        lock_guard<ProfiledMutex> lock(run_queue.queue_mutex);
+        run_queue.processes.push_back(process);
+    }
+    notifyDispatchEvent();
+}
+
+// Admit one process from the shared ready ring into our own deque, then run
+// the oldest entry in the deque. Pulling from the ring on every pick keeps
+// fresh arrivals interleaved with RR requeues instead of starving behind them.
+// Only when both are empty do we steal, from the back of a peer's deque so we
+// rarely touch the end its owner is working on.
+// While admission is blocked (memory was full at our last attempt) the ring is
+// left alone and only processes that already hold memory are stolen.
+PCB* acquireNextProcess(int core_id, bool admit) {
+    PCB* process = nullptr;
+    {
+        CoreRunQueue& own = *g_core_run_queues[core_id];
+        lock_guard<ProfiledMutex> lock(own.queue_mutex);
+        if (admit && g_ready_queue.tryPop(process)) {
+            own.processes.push_back(process);
         }
-        if (process_to_schedule != nullptr) {
-            // 🔽 COMMENT OUT THESE TWO LINES TO STOP LOG SPAM 🔽
-            // printMemoryState("Before allocation");
-            // printMemoryState("After allocation");
-
-            bool scheduled = false;
-            while (!scheduled && !g_exit_flag) {
-                {
-                    lock_guard<mutex> lock(g_process_lists_mutex);
-                    for (int i = 0; i < config_num_cpu; ++i) {
-                        if (g_running_processes[i] == nullptr) {
-                            if (allocateMemoryFirstFit(process_to_schedule)) {
-                                process_to_schedule->state = RUNNING;
-                                process_to_schedule->core_id = i;
-                                process_to_schedule->remaining_quantum = config_quantum_cycles;
-                                g_running_processes[i] = process_to_schedule;
-                                scheduled = true;
-                                break;
-                            }
-                        }
-                    }
-                }
-                if (!scheduled) {
-                    {
-                        lock_guard<mutex> lock(g_ready_queue_mutex);
-                        g_ready_queue.push(process_to_schedule);
-                    }
-                    this_thread::sleep_for(chrono::milliseconds(50));
-                    break;
-                }
-            }
-            // 🔽 COMMENT OUT THIS LINE TOO 🔽
-            // printMemoryState("After allocation");
-        } else {
-            this_thread::sleep_for(chrono::milliseconds(100));
+        if (!own.processes.empty()) {
+            process = own.processes.front();
+            own.processes.pop_front();
+            return process;
         }
     }
+
+    for (int offset = 1; offset < config_num_cpu; ++offset) {
+        CoreRunQueue& victim = *g_core_run_queues[(core_id + offset) % config_num_cpu];
+        lock_guard<ProfiledMutex> lock(victim.queue_mutex);
+        if (!victim.processes.empty() && (admit || victim.processes.back()->is_allocated)) {
+            process = victim.processes.back();
+            victim.processes.pop_back();
+            return process;
+        }
+    }
+    return nullptr;
+}
+
+// Put a process on this core. Processes requeued by RR keep their memory, so
+// only fresh ones go through the allocator. On failure the process goes back
+// to the shared ring so any core can retry it once memory frees up.
+bool dispatchProcess(int core_id, PCB* process) {
+    if (!process->is_allocated && !allocateMemory(process)) {
+        pushReadyProcess(process);
+        return false;
+    }
+
+    recordDispatchLatency(g_cpu_ticks.load() - process->ready_tick);
+
+    process->state = RUNNING;
+    process->core_id = core_id;
+    process->remaining_quantum = config_quantum_cycles;
+    g_running_processes[core_id].store(process);  // publishes the fields above
+    return true;
+}
+
+// The process is listed as finished before its running slot is cleared, so a
+// report never misses it, and its memory is freed with no list lock held.
+void finishProcess(int core_id, PCB* process) {
+    process->program = Program();
+    process->program_chunk = -1;
+
+    {
+        lock_guard<ProfiledMutex> lock(g_process_lists_mutex);
+        process->state = FINISHED;
+        g_finished_processes.push_back(process);
+    }
+    g_running_processes[core_id].store(nullptr);
+    deallocateMemory(process);
+}
+
+// Wait out delay-per-exec, then execute the process's next instruction.
+void executeNextInstruction(int core_id, PCB* process) {
+    if (config_delay_per_exec > 0) {
+        unsigned long long start_tick = g_cpu_ticks.load();
+        waitUntilTick(start_tick + config_delay_per_exec);
+
+        // Count each CPU tick spent executing as active
+        g_active_cpu_ticks += g_cpu_ticks.load() - start_tick;
+    } else if (g_virtual_time) {
+        // A wall-clock tick fits as many instructions as the host can run, so
+        // give each core a quantum's worth per virtual tick. Parking once it
+        // is spent is also what lets the clock advance past a busy core.
+        unsigned long long now = g_cpu_ticks.load();
+        if (now != t_budget_tick) {
+            t_budget_tick = now;
+            t_budget_used = 0;
+        }
+        if (t_budget_used == max(config_quantum_cycles, 1)) {
+            waitUntilTick(now + 1);
+            t_budget_tick = g_cpu_ticks.load();
+            t_budget_used = 0;
+        }
+        ++t_budget_used;
+    }
+
+    if (g_exit_flag.load()) return;
+
+    // Simulate memory access for paging on EVERY instruction
+    simulateMemoryAccess(process);
+
+    uint16_t values_before[RegisterFile::MAX_REGISTERS];
+    memcpy(values_before, process->registers.values, sizeof(values_before));
+    try {
+        executeProgramStep(process, process->instructions_executed);
+    } catch (const exception& e) {
+        lock_guard<mutex> lock(outputMutex);
+        cerr << "Core " << core_id << ": Error in "
+             << process->name << " - " << e.what() << endl;
+    }
+
+    // The symbol table lives at the start of the process's memory, so a step
+    // that changed a variable dirties those pages
+    if (memcmp(values_before, process->registers.values, sizeof(values_before)) != 0) {
+        storeProcessBytes(process, 0, process->registers.values, sizeof(process->registers.values));
+    }
+    process->instructions_executed++;
+    g_instructions_executed++;
 }
 
 void fcfs_worker_thread(int core_id) {
+    t_core_id = core_id;
+    unsigned long long blocked_event = ULLONG_MAX;  // event count at our last failed allocation
     while (!g_exit_flag) {
-        PCB* current_process = nullptr;
-        {
-            lock_guard<mutex> lock(g_process_lists_mutex);
-            if (core_id < g_running_processes.size()) {
-                current_process = g_running_processes[core_id];
-            }
+        unsigned long long seen_event = g_dispatch_events.load();
+        bool admit = seen_event != blocked_event;
+        PCB* current_process = acquireNextProcess(core_id, admit);
+
+        if (current_process == nullptr) {
+            // IDLE: Core has no process to execute. If memory was full, also
+            // retry admission on the next tick.
+            waitForDispatchEvent(seen_event, !admit);
+            blocked_event = ULLONG_MAX;
+            continue;
         }
-        
-        if (current_process != nullptr) {
-            // ACTIVE: Core is executing a process
-            g_active_cpu_ticks++;
-            
-            variables.clear();
-            variables["var1"] = 0;
-            variables["var2"] = 0;
-            variables["var3"] = 0;
-            
-            while (current_process->instructions_executed < current_process->instructions_total && !g_exit_flag) {
-                for (int tick_count = 0; tick_count < config_delay_per_exec; ++tick_count) {
-                    if (g_exit_flag) break;
-                    unsigned long long last_known_tick = g_cpu_ticks.load();
-                    unique_lock<mutex> lock(g_tick_mutex);
-                    g_tick_cv.wait(lock, [&]{
-                        return g_cpu_ticks.load() > last_known_tick || g_exit_flag.load();
-                    });
-                    
-                    // Increment active ticks for each CPU tick spent executing
-                    g_active_cpu_ticks++;
-                }
-                
-                if (g_exit_flag) break;
-                
-                // Simulate memory access for paging on EVERY instruction
-                simulateMemoryAccess(current_process->name);
-                
-                std::vector<std::string> singleInstruction = generateRandomInstructions(
-                    current_process->name, 1, enable_sleep, enable_for);
-                try {
-                    executeInstructionSet(singleInstruction, 0, current_process);
-                } catch (const std::exception& e) {
-                    std::lock_guard<std::mutex> lock(outputMutex);
-                    std::cerr << "Error executing instruction in process " << current_process->name << ": " << e.what() << std::endl;
-                }
-                current_process->instructions_executed++;
-            }
-            
-            if (!g_exit_flag) {
-                lock_guard<mutex> lock(g_process_lists_mutex);
-                current_process->state = FINISHED;
-                g_finished_processes.push_back(current_process);
-                g_running_processes[core_id] = nullptr;
-            }
-        } else {
-            // IDLE: Core has no process to execute
-            g_idle_cpu_ticks++;
-            this_thread::sleep_for(chrono::milliseconds(100));
+        if (!dispatchProcess(core_id, current_process)) {
+            // Not enough memory: run whatever already holds memory until
+            // something is freed
+            blocked_event = seen_event;
+            continue;
+        }
+
+        // ACTIVE: Core is executing a process
+        g_active_cpu_ticks++;
+
+        while (current_process->instructions_executed < current_process->instructions_total && !g_exit_flag) {
+            executeNextInstruction(core_id, current_process);
+        }
+
+        if (!g_exit_flag) {
+            finishProcess(core_id, current_process);
         }
     }
 }
 
 void rr_worker_thread(int core_id) {
-    // Thread-local counter for sequential filenames
-    static thread_local int thread_file_counter = 0;
-    
+    t_core_id = core_id;
+    unsigned long long blocked_event = ULLONG_MAX;  // event count at our last failed allocation
     while (!g_exit_flag.load()) {
-        PCB* current_process = nullptr;
-        
-        // Get current process for this core
-        {
-            lock_guard<mutex> lock(g_process_lists_mutex);
-            if (core_id < static_cast<int>(g_running_processes.size())) {
-                current_process = g_running_processes[core_id];
-            }
+        unsigned long long seen_event = g_dispatch_events.load();
+        bool admit = seen_event != blocked_event;
+        PCB* current_process = acquireNextProcess(core_id, admit);
+
+        if (current_process == nullptr) {
+            // IDLE: Core has no process to execute. If memory was full, also
+            // retry admission on the next tick.
+            waitForDispatchEvent(seen_event, !admit);
+            blocked_event = ULLONG_MAX;
+            continue;
+        }
+        if (!dispatchProcess(core_id, current_process)) {
+            // Not enough memory: run whatever already holds memory until
+            // something is freed
+            blocked_event = seen_event;
+            continue;
         }
 
-        if (current_process != nullptr) {
-            // ACTIVE: Core is executing a process
+        // ACTIVE: Run the process for at most one quantum
+        while (current_process->remaining_quantum > 0 &&
+               current_process->instructions_executed < current_process->instructions_total &&
+               !g_exit_flag.load()) {
             g_active_cpu_ticks++;
-            
-            // 1. Handle quantum expiration
+            executeNextInstruction(core_id, current_process);
             current_process->remaining_quantum--;
-            
-            if (current_process->remaining_quantum <= 0) {
-                // Reset quantum
-                current_process->remaining_quantum = config_quantum_cycles;
-                
-                // Reset process variables
-                variables.clear();
-                variables["var1"] = 0;
-                variables["var2"] = 0;
-                variables["var3"] = 0;
-            }
+        }
 
-            // 2. Execute process instructions
-            if (current_process->instructions_executed < current_process->instructions_total && !g_exit_flag.load()) {
-                for (int tick_count = 0; tick_count < config_delay_per_exec; ++tick_count) {
-                    if (g_exit_flag.load()) break;
-                    
-                    unsigned long long last_known_tick = g_cpu_ticks.load();
-                    unique_lock<mutex> lock(g_tick_mutex);
-                    g_tick_cv.wait(lock, [&]{
-                        return g_cpu_ticks.load() > last_known_tick || g_exit_flag.load();
-                    });
-                    
-                    // Increment active ticks for each CPU tick spent executing
-                    g_active_cpu_ticks++;
-                }
-                
-                if (!g_exit_flag.load()) {
-                    // Simulate memory access for paging on EVERY instruction
-                    simulateMemoryAccess(current_process->name);
-                    
-                    try {
-                        auto instruction = generateRandomInstructions(
-                            current_process->name, 1, enable_sleep, enable_for);
-                        executeInstructionSet(instruction, 0, current_process);
-                    } catch (const exception& e) {
-                        lock_guard<mutex> lock(outputMutex);
-                        cerr << "Core " << core_id << ": Error in " 
-                             << current_process->name << " - " << e.what() << endl;
-                    }
-                    current_process->instructions_executed++;
-                }
-            }
+        if (g_exit_flag.load()) break;
 
-            // 3. Handle process state transitions
-            bool process_finished = (current_process->instructions_executed >= 
-                                    current_process->instructions_total);
-            bool quantum_expired = (current_process->remaining_quantum <= 0);
-
-            if (process_finished) {
-                lock_guard<mutex> lock(g_process_lists_mutex);
-                current_process->state = FINISHED;
-                g_finished_processes.push_back(current_process);
-                g_running_processes[core_id] = nullptr;
-                deallocateMemory(current_process);
-                // cerr << "Core " << core_id << ": " 
-                //      << current_process->name << " FINISHED\n";
-            }
-            else if (quantum_expired) {
-                lock_guard<mutex> lock(g_process_lists_mutex);
-                current_process->state = READY;
-                g_running_processes[core_id] = nullptr;
-                
-                {
-                    lock_guard<mutex> ready_lock(g_ready_queue_mutex);
-                    g_ready_queue.push(current_process);
-                }
-                cerr << "Core " << core_id << ": " 
-                     << current_process->name << " requeued\n";
-            }
+        if (current_process->instructions_executed >= current_process->instructions_total) {
+            finishProcess(core_id, current_process);
         } else {
-            // IDLE: Core has no process to execute
-            g_idle_cpu_ticks++;
-            this_thread::sleep_for(chrono::milliseconds(10));
+            // Quantum expired: requeue on this core. Its variables stay in its
+            // own register file until it runs again. A peer may steal it, so
+            // its queued stores must land before a later one from that peer.
+            flushPendingTouches();
+            current_process->state = READY;
+            current_process->ready_tick = g_cpu_ticks.load();
+            g_running_processes[core_id].store(nullptr);
+            pushLocalProcess(core_id, current_process);
         }
     }
 }
 
-void createTestProcesses(const string& screenName) {
-    lock_guard<mutex> lock(g_ready_queue_mutex);
-    static int process_counter = 1; // Add this static counter
+void createTestProcesses() {
+
+    // Leave room in the ring for every process that may be requeued by a core
+    // and count the batch that does not fit as skipped
+    size_t limit = READY_QUEUE_CAPACITY - static_cast<size_t>(config_num_cpu) - 1;
+    if (g_ready_queue.size() + config_batch_process_freq > limit) {
+        g_generation_skipped += config_batch_process_freq;
+        return;
+    }
     
     for (int i = 0; i < config_batch_process_freq; ++i) {
+        // Everything random about a process comes from its own stream of the
+        // master seed, so a run can be replayed from random-seed alone
+        Xoshiro256 rng(deriveSeed(config_random_seed, static_cast<uint64_t>(g_generated_process_count)));
+
         // Calculate random memory requirement between min and max
-        int mem_needed = g_min_mem_per_proc + (rand() % (g_max_mem_per_proc - g_min_mem_per_proc + 1));
+        int mem_needed = g_min_mem_per_proc + static_cast<int>(rng.below(g_max_mem_per_proc - g_min_mem_per_proc + 1));
         
-        string processName = "P" + to_string(process_counter++); // Use sequential counter
+        string processName = "P" + to_string(g_generated_process_count++);
         string filename = "screen_" + processName + ".txt";
         
         // Use configured instruction count range
-        int instruction_count = config_min_ins + (rand() % (config_max_ins - config_min_ins + 1));
+        int instruction_count = config_min_ins + static_cast<int>(rng.below(config_max_ins - config_min_ins + 1));
         
         auto new_pcb = make_unique<PCB>(
-            process_counter - 1, // Use counter as ID
+            0,  // PID assigned by the registry
             processName,
             READY, 
             time(0), 
@@ -336,7 +664,16 @@ void createTestProcesses(const string& screenName) {
             mem_needed
         );
         
-        g_process_storage.push_back(std::move(new_pcb));
-        g_ready_queue.push(g_process_storage.back().get());
+        PCB* pcb = new_pcb.get();
+        registerProcess(pcb);
+        pcb->registers.reset();
+        pcb->program_seed = rng();
+        pcb->ready_tick = g_cpu_ticks.load();
+        {
+            lock_guard<ProfiledMutex> lock(g_process_lists_mutex);
+            g_process_storage.push_back(std::move(new_pcb));
+        }
+        pushReadyProcess(pcb);
     }
+    notifyDispatchEvent();
 }
\ No newline at end of file
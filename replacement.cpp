@@ -0,0 +1,252 @@
+// replacement.cpp
+// Page replacement policies. The pager tells the policy which frames get
+// loaded, accessed and freed, and asks it for a victim when no frame is free.
+// All calls are made under g_paging_mutex.
+#include "headers.h"
+#include <list>
+
+namespace {
+
+// Doubly-linked lists of frame numbers threaded through shared link arrays.
+// A frame is on at most one list at a time, so several lists can share them.
+struct FrameLinks {
+    vector<int> prev;
+    vector<int> next;
+
+    void reset(int total_frames) {
+        prev.assign(total_frames, -1);
+        next.assign(total_frames, -1);
+    }
+};
+
+struct FrameList {
+    int head = -1;  // oldest
+    int tail = -1;  // newest
+    int size = 0;
+
+    void pushBack(FrameLinks& links, int frame) {
+        links.prev[frame] = tail;
+        links.next[frame] = -1;
+        if (tail != -1) links.next[tail] = frame;
+        else head = frame;
+        tail = frame;
+        ++size;
+    }
+
+    void remove(FrameLinks& links, int frame) {
+        if (links.prev[frame] != -1) links.next[links.prev[frame]] = links.next[frame];
+        else head = links.next[frame];
+        if (links.next[frame] != -1) links.prev[links.next[frame]] = links.prev[frame];
+        else tail = links.prev[frame];
+        links.prev[frame] = links.next[frame] = -1;
+        --size;
+    }
+};
+
+// Evicts in load order; accesses do not matter
+class FifoPolicy : public ReplacementPolicy {
+public:
+    const char* name() const override { return "FIFO"; }
+    void reset(int total_frames) override {
+        links.reset(total_frames);
+        queue = FrameList{};
+    }
+    void onLoad(int frame, uint64_t) override { queue.pushBack(links, frame); }
+    void onAccess(int) override {}
+    void onRemove(int frame, uint64_t, bool) override { queue.remove(links, frame); }
+    int chooseVictim(uint64_t) override { return queue.head; }
+
+protected:
+    FrameLinks links;
+    FrameList queue;
+};
+
+// Exact LRU: the FIFO queue, but an access moves the frame to the back
+class LruPolicy : public FifoPolicy {
+public:
+    const char* name() const override { return "LRU"; }
+    void onAccess(int frame) override {
+        if (queue.tail != frame) {
+            queue.remove(links, frame);
+            queue.pushBack(links, frame);
+        }
+    }
+};
+
+// Second chance: a hand sweeps the frames, clearing reference bits, and
+// evicts the first resident frame whose bit is already clear
+class ClockPolicy : public ReplacementPolicy {
+public:
+    const char* name() const override { return "CLOCK"; }
+    void reset(int total_frames) override {
+        resident.assign(total_frames, 0);
+        referenced.assign(total_frames, 0);
+        hand = 0;
+    }
+    void onLoad(int frame, uint64_t) override {
+        resident[frame] = 1;
+        referenced[frame] = 1;
+    }
+    void onAccess(int frame) override { referenced[frame] = 1; }
+    void onRemove(int frame, uint64_t, bool) override {
+        resident[frame] = 0;
+        referenced[frame] = 0;
+    }
+    int chooseVictim(uint64_t) override {
+        int total_frames = static_cast<int>(resident.size());
+        // Two sweeps always suffice: the first clears every bit
+        for (int step = 0; step < 2 * total_frames; ++step) {
+            int frame = hand;
+            hand = (hand + 1) % total_frames;
+            if (!resident[frame]) continue;
+            if (!referenced[frame]) return frame;
+            referenced[frame] = 0;
+        }
+        return -1;
+    }
+
+private:
+    vector<char> resident;
+    vector<char> referenced;
+    int hand = 0;
+};
+
+// Adaptive Replacement Cache (Megiddo & Modha). T1 holds pages seen once
+// recently, T2 pages seen at least twice; B1/B2 remember pages recently
+// evicted from each. A fault on a B1 ghost grows the target size p of T1, a
+// fault on a B2 ghost shrinks it. Adaptation happens in onMiss, so the victim
+// for the fault is chosen against the adapted p.
+class ArcPolicy : public ReplacementPolicy {
+public:
+    const char* name() const override { return "ARC"; }
+    void reset(int total_frames) override {
+        capacity = total_frames;
+        target_t1 = 0;
+        links.reset(total_frames);
+        in_t2.assign(total_frames, 0);
+        t1 = FrameList{};
+        t2 = FrameList{};
+        b1.clear();
+        b2.clear();
+        ghosts.clear();
+        incoming = {0, INCOMING_NEW};
+    }
+
+    void onMiss(uint64_t key) override {
+        incoming = {key, INCOMING_NEW};
+        auto ghost = ghosts.find(key);
+        if (ghost == ghosts.end()) return;
+
+        int b1_size = static_cast<int>(b1.size());
+        int b2_size = static_cast<int>(b2.size());
+        if (ghost->second.in_b2) {
+            target_t1 = max(0, target_t1 - max(1, b1_size / max(1, b2_size)));
+            b2.erase(ghost->second.position);
+            incoming.source = INCOMING_B2;
+        } else {
+            target_t1 = min(capacity, target_t1 + max(1, b2_size / max(1, b1_size)));
+            b1.erase(ghost->second.position);
+            incoming.source = INCOMING_B1;
+        }
+        ghosts.erase(ghost);
+    }
+
+    // A ghost hit goes straight to T2
+    void onLoad(int frame, uint64_t key) override {
+        if (incoming.key == key && incoming.source != INCOMING_NEW) {
+            t2.pushBack(links, frame);
+            in_t2[frame] = 1;
+        } else {
+            t1.pushBack(links, frame);
+            in_t2[frame] = 0;
+        }
+        incoming = {0, INCOMING_NEW};
+        trimGhosts();
+    }
+
+    void onAccess(int frame) override {
+        if (in_t2[frame]) {
+            if (t2.tail == frame) return;
+            t2.remove(links, frame);
+        } else {
+            t1.remove(links, frame);
+            in_t2[frame] = 1;
+        }
+        t2.pushBack(links, frame);
+    }
+
+    void onRemove(int frame, uint64_t key, bool evicted) override {
+        bool from_t2 = in_t2[frame];
+        (from_t2 ? t2 : t1).remove(links, frame);
+        in_t2[frame] = 0;
+        if (!evicted) return;  // freed pages are not coming back
+
+        list<uint64_t>& ghost_list = from_t2 ? b2 : b1;
+        ghost_list.push_back(key);
+        ghosts[key] = {from_t2, prev(ghost_list.end())};
+        trimGhosts();
+    }
+
+    int chooseVictim(uint64_t incoming_key) override {
+        bool incoming_in_b2 = incoming.key == incoming_key && incoming.source == INCOMING_B2;
+        if (t1.size > 0 && (t1.size > target_t1 || (incoming_in_b2 && t1.size == target_t1))) {
+            return t1.head;
+        }
+        return t2.size > 0 ? t2.head : t1.head;
+    }
+
+private:
+    struct Ghost {
+        bool in_b2;
+        list<uint64_t>::iterator position;
+    };
+
+    // Where the page being faulted in was found by onMiss
+    enum IncomingSource { INCOMING_NEW, INCOMING_B1, INCOMING_B2 };
+    struct Incoming {
+        uint64_t key;
+        IncomingSource source;
+    };
+
+    // Keep |T1| + |B1| <= c and the whole directory within 2c
+    void trimGhosts() {
+        while (!b1.empty() && t1.size + static_cast<int>(b1.size()) > capacity) {
+            dropOldestGhost(b1);
+        }
+        while (t1.size + t2.size + static_cast<int>(b1.size() + b2.size()) > 2 * capacity) {
+            dropOldestGhost(b2.empty() ? b1 : b2);
+        }
+    }
+
+    void dropOldestGhost(list<uint64_t>& ghost_list) {
+        ghosts.erase(ghost_list.front());
+        ghost_list.pop_front();
+    }
+
+    int capacity = 0;
+    int target_t1 = 0;  // p
+    FrameLinks links;
+    vector<char> in_t2;
+    FrameList t1;
+    FrameList t2;
+    list<uint64_t> b1;  // front is oldest
+    list<uint64_t> b2;
+    unordered_map<uint64_t, Ghost> ghosts;
+    Incoming incoming = {0, INCOMING_NEW};
+};
+
+}  // namespace
+
+unique_ptr<ReplacementPolicy> makeReplacementPolicy(PageReplacementType type) {
+    switch (type) {
+        case REPLACE_FIFO:
+            return make_unique<FifoPolicy>();
+        case REPLACE_CLOCK:
+            return make_unique<ClockPolicy>();
+        case REPLACE_ARC:
+            return make_unique<ArcPolicy>();
+        case REPLACE_LRU:
+        default:
+            return make_unique<LruPolicy>();
+    }
+}
@@ -0,0 +1,83 @@
+// tlb_store_test.cpp
+// A worker core whose TLB maps a process's symbol table should store into it
+// without the paging lock: stores and hits are queued and the lock is only
+// taken to flush a full batch or on a miss. A queued store is not lost when
+// its page is evicted first.
+#include "../headers.h"
+
+int main() {
+    g_max_overall_mem = 16384;
+    g_mem_per_frame = 16;
+    g_min_mem_per_proc = 64;
+    g_max_mem_per_proc = 64;
+    config_num_cpu = 1;
+    config_access_pattern = ACCESS_SEQUENTIAL;
+    config_compaction_threshold = 0;
+    initializeCores();
+    initializeMemory();
+
+    PCB process(0, "tlb", READY, time(nullptr), 0, 0, "", 0, 64);
+    registerProcess(&process);
+    if (!allocateMemory(&process)) {
+        cerr << "FAIL: could not allocate the test process" << endl;
+        return 1;
+    }
+
+    // Warm the TLB with every page of the symbol table
+    t_core_id = 0;
+    const int INSTRUCTIONS = 10000;
+    for (int i = 0; i < calculatePagesRequired(sizeof(process.registers.values)); ++i) {
+        simulateMemoryAccess(&process);
+    }
+    long long tlb_hits_before, tlb_misses_before;
+    tlbStats(tlb_hits_before, tlb_misses_before);
+    g_paging_mutex.resetStats();
+
+    for (int i = 0; i < INSTRUCTIONS; ++i) {
+        simulateMemoryAccess(&process);
+        process.registers.values[i % RegisterFile::MAX_REGISTERS]++;
+        storeProcessBytes(&process, 0, process.registers.values, sizeof(process.registers.values));
+    }
+
+    long long tlb_hits, tlb_misses;
+    tlbStats(tlb_hits, tlb_misses);
+    tlb_hits -= tlb_hits_before;
+    tlb_misses -= tlb_misses_before;
+    long long locks = g_paging_mutex.stats().acquisitions;
+    cout << INSTRUCTIONS << " instructions: " << tlb_hits << " TLB hits, " << tlb_misses << " misses, "
+         << locks << " paging lock acquisitions" << endl;
+
+    // A store still queued when its page is evicted must reach swap. Write
+    // page 0 out and bring it back clean first.
+    flushPendingTouches();
+    pageOut(&process, 0);
+    for (int i = 0; i < calculatePagesRequired(sizeof(process.registers.values)); ++i) {
+        simulateMemoryAccess(&process);
+    }
+    process.registers.values[0]++;
+    storeProcessBytes(&process, 0, process.registers.values, sizeof(process.registers.values));
+    long long swap_written = g_swap_bytes_written.load();
+    pageOut(&process, 0);
+    bool store_written_back = g_swap_bytes_written.load() > swap_written;
+
+    t_core_id = -1;
+    deallocateMemory(&process);
+    stopCompactor();
+    closePagingSystem();
+    closeSwapDevice();
+
+    if (!store_written_back) {
+        cerr << "FAIL: evicting a page dropped the store queued for it" << endl;
+        return 1;
+    }
+    if (tlb_misses != 0) {
+        cerr << "FAIL: a warm TLB missed" << endl;
+        return 1;
+    }
+    // One lock per flushed batch, far fewer than one per instruction
+    if (locks * 4 > INSTRUCTIONS || locks * 16 > tlb_hits) {
+        cerr << "FAIL: paging lock taken " << locks << " times for " << tlb_hits << " TLB hits" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -39,7 +39,7 @@ string format_timestamp_for_display(time_t t) {
 }
 
 string getSystemReport() {
-    lock_guard<mutex> lock(g_process_lists_mutex);
+    lock_guard<ProfiledMutex> lock(g_process_lists_mutex);
     stringstream ss;
 
     ss << "==== CPU UTILIZATION REPORT ====\n";
@@ -60,21 +60,12 @@ string getSystemReport() {
     }
     ss << endl;
 
-    int ready_count = 0;
-    {
-        lock_guard<mutex> ready_lock(g_ready_queue_mutex);
-        queue<PCB*> temp_queue = g_ready_queue;
-        while (!temp_queue.empty()) {
-            ready_count++;
-            temp_queue.pop();
-        }
-    }
-    ss << "Processes in Ready Queue: " << ready_count << endl;
+    ss << "Processes in Ready Queue: " << readyProcessCount() << endl;
 
     ss << "\n==== RUNNING PROCESSES ====\n";
     bool anyRunning = false;
     for (int i = 0; i < config_num_cpu; ++i) {
-        PCB* p = g_running_processes[i];
+        PCB* p = g_running_processes[i].load();
         if (p != nullptr) {
             ss << p->name << "\t" << format_timestamp_for_display(p->creation_time) << "\t"
                << "Core: " << p->core_id << "\t"